@@ -0,0 +1,111 @@
+/*
+  banks.cc -- checks for splitting screens into charset banks
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "PaletteRegistry.h"
+#include "test-utils.h"
+#include "utils.h"
+#include "write_png.h"
+
+static std::string program;
+
+static void check_banks() {
+    auto rng = std::mt19937(8);
+    auto palette = PaletteRegistry::get("c64-colodore");
+    const size_t width = 10;
+    const size_t height = 10;
+    const size_t max_characters = 128;
+
+    auto tiles = std::vector<uint64_t>(150);
+    for (auto& tile : tiles) {
+        tile = random_tile(rng);
+    }
+
+    // Screen 1 needs 50 characters not in bank 0, screen 2 only characters from screen 1.
+    const size_t first_tiles[] = {0, 50, 50};
+    const uint8_t expected_banks[] = {0, 1, 1};
+    auto images = std::vector<std::shared_ptr<Image>>();
+    auto arguments = std::vector<std::string>{"-b", "0", "--charset-banks", "--max-characters", std::to_string(max_characters), "screen", "", "banks-charset.bin"};
+    for (size_t screen = 0; screen < 3; screen++) {
+        auto image = std::make_shared<Image>(width * 8, height * 8, palette);
+        for (size_t cell = 0; cell < width * height; cell++) {
+            draw_tile(*image, cell % width, cell / width, tiles[first_tiles[screen] + (cell * 7) % 100], 1, 0);
+        }
+        auto file_name = "banks-screen-" + std::to_string(screen);
+        image_write_png(file_name + ".png", ImageView(image));
+        arguments.push_back(file_name + ".png");
+        images.push_back(image);
+    }
+
+    for (const auto& file_name : {"banks-charset-0.bin", "banks-charset-1.bin", "banks-charset-2.bin", "banks-charset-banks.bin"}) {
+        std::remove(file_name);
+    }
+    run_program(program, arguments);
+
+    auto banks = load_file("banks-charset-banks.bin");
+    check(banks == std::vector<uint8_t>(expected_banks, expected_banks + 3), "wrong bank ids");
+    if (auto fp = std::fopen("banks-charset-2.bin", "rb")) {
+        std::fclose(fp);
+        check(false, "charset written for unused bank 2");
+    }
+
+    for (size_t screen = 0; screen < 3; screen++) {
+        auto charset = load_file("banks-charset-" + std::to_string(expected_banks[screen]) + ".bin");
+        auto indices = load_file("banks-screen-" + std::to_string(screen) + ".bin");
+        check(charset.size() <= max_characters * 8, "charset of bank " + std::to_string(expected_banks[screen]) + " too large");
+        check(indices.size() == width * height, "wrong size of screen " + std::to_string(screen));
+        if (indices.size() != width * height) {
+            continue;
+        }
+        for (size_t cell = 0; cell < width * height; cell++) {
+            check(cell_matches(*images[screen], cell % width, cell / width, character(charset, indices[cell]), 1, 0), "screen " + std::to_string(screen) + " cell " + std::to_string(cell) + " differs in its bank");
+        }
+    }
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s gfx-convert\n", argv[0]);
+        return 1;
+    }
+    program = argv[1];
+
+    return run_checks(check_banks);
+}
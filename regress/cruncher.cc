@@ -0,0 +1,169 @@
+/*
+  cruncher.cc -- round trip check for LZ4 compression
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Cruncher.h"
+#include "test-utils.h"
+#include "utils.h"
+
+// Decode LZ4 block, returns false if data is not a valid block.
+static bool lz4_decode(const std::vector<uint8_t>& data, std::vector<uint8_t>& output) {
+    size_t position = 0;
+    auto read_length = [&](size_t length) {
+        if (length == 15) {
+            uint8_t byte;
+            do {
+                if (position >= data.size()) {
+                    return SIZE_MAX;
+                }
+                byte = data[position++];
+                length += byte;
+            } while (byte == 255);
+        }
+        return length;
+    };
+
+    output.clear();
+    while (position < data.size()) {
+        auto token = data[position++];
+        auto literals = read_length(token >> 4);
+        if (literals == SIZE_MAX || literals > data.size() - position) {
+            return false;
+        }
+        output.insert(output.end(), data.begin() + position, data.begin() + position + literals);
+        position += literals;
+        if (position == data.size()) {
+            // Last sequence has only literals.
+            return true;
+        }
+        if (data.size() - position < 2) {
+            return false;
+        }
+        size_t offset = data[position] | (data[position + 1] << 8);
+        position += 2;
+        auto match = read_length(token & 0xf);
+        if (match == SIZE_MAX || offset == 0 || offset > output.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < match + 4; i++) {
+            output.push_back(output[output.size() - offset]);
+        }
+    }
+    return output.empty();
+}
+
+
+static void check_cruncher() {
+    auto rng = std::mt19937(1);
+    auto inputs = std::vector<std::vector<uint8_t>>();
+
+    inputs.emplace_back();
+    for (size_t length = 1; length <= 20; length++) {
+        auto& input = inputs.emplace_back(length);
+        for (auto& byte : input) {
+            byte = static_cast<uint8_t>(rng() % 3);
+        }
+    }
+    inputs.emplace_back(100000, 0);
+    auto& noise = inputs.emplace_back(70000);
+    for (auto& byte : noise) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    // Repeated blocks at near and far offsets, mixed with new data.
+    auto& mixed = inputs.emplace_back();
+    while (mixed.size() < 200000) {
+        auto length = 1 + rng() % 300;
+        if (mixed.size() > length && rng() % 2 == 0) {
+            auto start = mixed.size() - 1 - rng() % std::min(mixed.size() - 1, size_t{70000});
+            for (size_t i = 0; i < length; i++) {
+                mixed.push_back(mixed[start + i]);
+            }
+        }
+        else {
+            for (size_t i = 0; i < length; i++) {
+                mixed.push_back(static_cast<uint8_t>(rng() % 4));
+            }
+        }
+    }
+
+    auto cruncher = Cruncher();
+    for (const auto& input : inputs) {
+        auto compressed = cruncher.crunch(input.data(), input.size());
+        auto decompressed = std::vector<uint8_t>();
+        check(lz4_decode(compressed, decompressed), "invalid LZ4 block for input of " + std::to_string(input.size()) + " bytes");
+        check(decompressed == input, "LZ4 round trip differs for input of " + std::to_string(input.size()) + " bytes");
+    }
+}
+
+
+static void check_compressed_files() {
+    auto rng = std::mt19937(16);
+    auto files = std::vector<std::vector<uint8_t>>(20);
+    for (auto& data : files) {
+        data.resize(rng() % 5000);
+        for (auto& byte : data) {
+            byte = static_cast<uint8_t>(rng() % 8);
+        }
+    }
+
+    set_compress_files(true);
+    auto first = std::vector<uint8_t>(1000, 1);
+    save_file("compressed-0.bin", first);
+    for (size_t i = 0; i < files.size(); i++) {
+        save_file("compressed-" + std::to_string(i) + ".bin", files[i]);
+    }
+    write_compressed_files();
+    set_compress_files(false);
+
+    // Later save of the same file wins.
+    for (size_t i = 0; i < files.size(); i++) {
+        auto file_name = "compressed-" + std::to_string(i) + ".bin";
+        auto decompressed = std::vector<uint8_t>();
+        check(lz4_decode(load_file(file_name), decompressed), "invalid LZ4 block in " + file_name);
+        check(decompressed == files[i], file_name + " differs from last saved data");
+    }
+}
+
+
+int main() {
+    return run_checks([] {
+        check_cruncher();
+        check_compressed_files();
+    });
+}
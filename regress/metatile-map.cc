@@ -0,0 +1,116 @@
+/*
+  metatile-map.cc -- round trip checks for metatile maps
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "MetatileMap.h"
+#include "PaletteRegistry.h"
+#include "test-utils.h"
+#include "utils.h"
+
+// Read 8 bit or 16 bit little endian value.
+static size_t read_index(const std::vector<uint8_t>& data, size_t index, bool wide) {
+    if (wide) {
+        return data[index * 2] | (data[index * 2 + 1] << 8);
+    }
+    return data[index];
+}
+
+
+// Convert map of width x height metatiles, each drawn from one of patterns, and check that saved files redraw image.
+static void check_map(const std::string& name, size_t width, size_t height, size_t patterns, uint32_t seed) {
+    auto rng = std::mt19937(seed);
+    auto palette = PaletteRegistry::get("c64-colodore");
+    const size_t metatile_size = 2;
+    const size_t cells = metatile_size * metatile_size;
+
+    auto pattern_tiles = std::vector<uint64_t>(patterns * cells);
+    for (auto& tile : pattern_tiles) {
+        tile = random_tile(rng);
+    }
+
+    // First cells use all patterns, the rest repeat them.
+    auto image = std::make_shared<Image>(width * metatile_size * 8, height * metatile_size * 8, palette);
+    for (size_t index = 0; index < width * height; index++) {
+        auto pattern = index < patterns ? index : rng() % patterns;
+        for (size_t cell = 0; cell < cells; cell++) {
+            draw_tile(*image, (index % width) * metatile_size + cell % metatile_size, (index / width) * metatile_size + cell / metatile_size, pattern_tiles[pattern * cells + cell], 1, 0);
+        }
+    }
+
+    auto options = CharsetOptions();
+    options.max_characters = 2048;
+    auto map = MetatileMap(metatile_size, options, 0, {});
+    for (size_t y = 0; y < image->get_height(); y += metatile_size * 8) {
+        map.add_band(ImageView(image, ImageView::Region(0, y, image->get_width(), metatile_size * 8)), y);
+    }
+    map.save(name);
+
+    auto charset = load_file(name + "-charset.bin");
+    auto metatiles = load_file(name + "-metatiles.bin");
+    auto data = load_file(name + "-map.bin");
+
+    auto wide_characters = charset.size() / 8 > 256;
+    auto wide_metatiles = patterns > 256;
+    auto metatile_count = metatiles.size() / (cells * (wide_characters ? 2 : 1));
+    check(charset.size() == patterns * cells * 8, name + ": wrong size of charset");
+    check(metatile_count == patterns, name + ": metatiles not deduplicated");
+    check(data.size() == width * height * (wide_metatiles ? 2 : 1), name + ": wrong size of map");
+    if (data.size() != width * height * (wide_metatiles ? 2 : 1)) {
+        return;
+    }
+
+    for (size_t index = 0; index < width * height; index++) {
+        auto metatile = read_index(data, index, wide_metatiles);
+        if (metatile >= metatile_count) {
+            check(false, name + ": map cell " + std::to_string(index) + " uses metatile beyond table");
+            continue;
+        }
+        for (size_t cell = 0; cell < cells; cell++) {
+            auto tile = character(charset, read_index(metatiles, metatile * cells + cell, wide_characters));
+            check(cell_matches(*image, (index % width) * metatile_size + cell % metatile_size, (index / width) * metatile_size + cell / metatile_size, tile, 1, 0), name + ": map cell " + std::to_string(index) + " differs");
+        }
+    }
+}
+
+
+int main() {
+    return run_checks([] {
+        check_map("map-narrow", 8, 4, 20, 11);
+        check_map("map-wide", 20, 15, 290, 12);
+    });
+}
@@ -0,0 +1,127 @@
+/*
+  reduce.cc -- checks for merging similar characters
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Charset.h"
+#include "PaletteRegistry.h"
+#include "TextScreen.h"
+#include "test-utils.h"
+#include "utils.h"
+
+static void check_reduced_screen() {
+    auto rng = std::mt19937(4);
+    auto palette = PaletteRegistry::get("c64-colodore");
+    const size_t width = 16;
+    const size_t height = 8;
+    const size_t max_characters = 32;
+
+    auto image = std::make_shared<Image>(width * 8, height * 8, palette);
+    auto tiles = std::vector<uint64_t>(width * height);
+    for (size_t cell = 0; cell < width * height; cell++) {
+        tiles[cell] = random_tile(rng);
+        draw_tile(*image, cell % width, cell / width, tiles[cell], 1, 0);
+    }
+
+    auto options = CharsetOptions();
+    options.max_characters = max_characters;
+    options.reduce = true;
+    auto screen = TextScreen(ImageView(image), 0, options);
+    screen.save("reduce");
+
+    auto charset = load_file("reduce-charset.bin");
+    auto indices = load_file("reduce-screen.bin");
+
+    check(charset.size() % 8 == 0 && charset.size() <= max_characters * 8, "reduced charset has " + std::to_string(charset.size()) + " bytes");
+    check(indices.size() == width * height, "wrong size of reduced screen");
+    if (indices.size() != width * height) {
+        return;
+    }
+    for (size_t cell = 0; cell < width * height; cell++) {
+        check(indices[cell] < charset.size() / 8, "cell " + std::to_string(cell) + " uses character beyond charset");
+        // Characters that were kept must still be used by the cells they came from.
+        for (size_t index = 0; index < charset.size() / 8; index++) {
+            if (character(charset, index) == tiles[cell]) {
+                check(indices[cell] == index, "cell " + std::to_string(cell) + " doesn't use its own character");
+            }
+        }
+    }
+}
+
+
+static void check_start_charset_kept() {
+    auto rng = std::mt19937(5);
+    const size_t fixed = 16;
+    const size_t added = 64;
+    const size_t max_characters = 32;
+
+    auto start = std::vector<uint8_t>(fixed * 8);
+    for (size_t index = 0; index < fixed; index++) {
+        auto tile = random_tile(rng);
+        memcpy(start.data() + index * 8, &tile, 8);
+    }
+
+    auto charset = Charset(start, Charset::unlimited);
+    for (size_t i = 0; i < added; i++) {
+        auto tile = random_tile(rng);
+        charset.add(reinterpret_cast<const uint8_t *>(&tile));
+    }
+
+    auto mapping = charset.reduce(max_characters);
+    check(mapping.size() == fixed + added, "mapping has wrong size");
+    check(charset.get_size() <= max_characters, "reduced charset has " + std::to_string(charset.get_size()) + " characters");
+    for (size_t index = 0; index < mapping.size(); index++) {
+        check(mapping[index] < charset.get_size(), "character " + std::to_string(index) + " mapped beyond charset");
+        if (index < fixed) {
+            check(mapping[index] == index, "start character " + std::to_string(index) + " moved");
+        }
+    }
+
+    charset.save("reduce-start.bin");
+    auto data = load_file("reduce-start.bin");
+    check(data.size() >= start.size() && std::equal(start.begin(), start.end(), data.begin()), "start characters changed");
+}
+
+
+int main() {
+    return run_checks([] {
+        check_reduced_screen();
+        check_start_charset_kept();
+    });
+}
@@ -0,0 +1,144 @@
+/*
+  sequence.cc -- round trip check for delta encoded frame sequences
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "FrameSequence.h"
+#include "PaletteRegistry.h"
+#include "test-utils.h"
+#include "utils.h"
+
+static void check_sequence() {
+    auto rng = std::mt19937(3);
+    auto palette = PaletteRegistry::get("c64-colodore");
+    const size_t width = 12;
+    const size_t height = 6;
+    const size_t frame_count = 7;
+
+    uint64_t tiles[20];
+    for (auto& tile : tiles) {
+        tile = random_tile(rng);
+    }
+    tiles[0] = 0;
+
+    // Each frame changes some cells of the previous one.
+    auto frames = std::vector<std::shared_ptr<Image>>();
+    auto cells = std::vector<size_t>(width * height, 0);
+    auto cell_colors = std::vector<uint8_t>(width * height, 1);
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        auto changes = frame == 0 ? width * height : rng() % 20;
+        for (size_t i = 0; i < changes; i++) {
+            auto cell = frame == 0 ? i : rng() % (width * height);
+            cells[cell] = 1 + rng() % 19;
+            cell_colors[cell] = static_cast<uint8_t>(1 + rng() % 15);
+        }
+        auto image = std::make_shared<Image>(width * 8, height * 8, palette);
+        for (size_t cell = 0; cell < width * height; cell++) {
+            draw_tile(*image, cell % width, cell / width, tiles[cells[cell]], cell_colors[cell], 0);
+        }
+        frames.push_back(image);
+    }
+
+    auto sequence = FrameSequence(CharsetOptions(), 3);
+    for (const auto& frame : frames) {
+        sequence.add_frame(ImageView(frame), 0);
+    }
+    sequence.save("sequence");
+
+    auto charset = load_file("sequence-charset.bin");
+    auto data = load_file("sequence-frames.bin");
+
+    auto screen = std::vector<uint8_t>(width * height);
+    auto colors = std::vector<uint8_t>(width * height);
+    size_t position = 0;
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        auto name = "frame " + std::to_string(frame);
+        if (position >= data.size()) {
+            check(false, name + " missing");
+            return;
+        }
+        auto type = data[position++];
+        check(type == (frame % 3 == 0 ? 0 : 1), name + " has wrong type");
+        if (type == 0) {
+            if (data.size() - position < width * height * 2) {
+                check(false, name + " truncated");
+                return;
+            }
+            std::copy(data.begin() + position, data.begin() + position + width * height, screen.begin());
+            position += width * height;
+            std::copy(data.begin() + position, data.begin() + position + width * height, colors.begin());
+            position += width * height;
+        }
+        else {
+            while (true) {
+                if (position >= data.size()) {
+                    check(false, name + " truncated");
+                    return;
+                }
+                size_t count = data[position++];
+                if (count == 0) {
+                    break;
+                }
+                if (data.size() - position < 2 + count * 2) {
+                    check(false, name + " truncated");
+                    return;
+                }
+                size_t offset = data[position] | (data[position + 1] << 8);
+                position += 2;
+                if (offset + count > width * height) {
+                    check(false, name + " has run beyond screen");
+                    return;
+                }
+                std::copy(data.begin() + position, data.begin() + position + count, screen.begin() + offset);
+                position += count;
+                std::copy(data.begin() + position, data.begin() + position + count, colors.begin() + offset);
+                position += count;
+            }
+        }
+
+        for (size_t cell = 0; cell < width * height; cell++) {
+            check(cell_matches(*frames[frame], cell % width, cell / width, character(charset, screen[cell]), colors[cell], 0), name + " cell " + std::to_string(cell) + " differs");
+        }
+    }
+    check(position == data.size(), "trailing data after last frame");
+}
+
+
+int main() {
+    return run_checks(check_sequence);
+}
@@ -0,0 +1,118 @@
+/*
+  shifted-charset.cc -- round trip checks for shifted charsets
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "PaletteRegistry.h"
+#include "ShiftedCharset.h"
+#include "test-utils.h"
+#include "utils.h"
+
+// Convert image with all shifts and check that each shifted character equals the pixels it covers, background beyond the image.
+static void check_shifts(const std::string& name, bool vertical, size_t max_characters, uint32_t seed) {
+    auto rng = std::mt19937(seed);
+    auto palette = PaletteRegistry::get("c64-colodore");
+    const size_t width = 5;
+    const size_t height = 3;
+    const size_t cells = width * height;
+
+    // Without vertical shifts, rows of cells are never combined, so each row can have its own color.
+    auto row_color = [vertical](size_t y) { return static_cast<uint8_t>(vertical ? 1 : 1 + y); };
+    auto image = std::make_shared<Image>(width * 8, height * 8, palette);
+    for (size_t cell = 0; cell < cells; cell++) {
+        // Some empty cells, so shifts combine empty and set pixels.
+        auto tile = rng() % 4 == 0 ? 0 : random_tile(rng);
+        draw_tile(*image, cell % width, cell / width, tile, row_color(cell / width), 0);
+    }
+
+    auto options = CharsetOptions();
+    options.max_characters = max_characters;
+    auto charset = ShiftedCharset(ImageView(image), 0, {}, vertical, options);
+    charset.save(name);
+
+    auto characters = load_file(name + "-charset.bin");
+    auto shifts = load_file(name + "-shifts.bin");
+    auto colors = load_file(name + "-colors.bin");
+
+    auto shift_count = vertical ? size_t{64} : size_t{8};
+    auto wide = max_characters > 256;
+    check(shifts.size() == shift_count * cells * (wide ? 2 : 1), name + ": wrong size of shifts");
+    check(colors.size() == shift_count * cells, name + ": wrong size of colors");
+    if (shifts.size() != shift_count * cells * (wide ? 2 : 1) || colors.size() != shift_count * cells) {
+        return;
+    }
+
+    auto pixel = [&](size_t x, size_t y) -> uint8_t {
+        return x < image->get_width() && y < image->get_height() ? image->get(x, y) : 0;
+    };
+
+    for (size_t shift = 0; shift < shift_count; shift++) {
+        auto x_shift = shift % 8;
+        auto y_shift = shift / 8;
+        for (size_t cell = 0; cell < cells; cell++) {
+            auto i = shift * cells + cell;
+            auto index = wide ? shifts[i * 2] | (shifts[i * 2 + 1] << 8) : shifts[i];
+            auto tile = character(characters, index);
+            auto bytes = reinterpret_cast<const uint8_t *>(&tile);
+            auto matches = true;
+            std::optional<uint8_t> foreground_color;
+            for (size_t y = 0; y < 8; y++) {
+                for (size_t x = 0; x < 8; x++) {
+                    auto color = pixel((cell % width) * 8 + x_shift + x, (cell / width) * 8 + y_shift + y);
+                    if (((bytes[y] & (0x80 >> x)) != 0) != (color != 0)) {
+                        matches = false;
+                    }
+                    if (color != 0) {
+                        foreground_color = color;
+                    }
+                }
+            }
+            auto position = name + ": shift " + std::to_string(x_shift) + "," + std::to_string(y_shift) + " cell " + std::to_string(cell);
+            check(matches, position + " differs from neighboring pixels");
+            check(colors[i] == foreground_color.value_or(0), position + " has wrong color");
+        }
+    }
+}
+
+
+int main() {
+    return run_checks([] {
+        check_shifts("shifted", false, 256, 13);
+        check_shifts("shifted-vertical", true, 1024, 14);
+    });
+}
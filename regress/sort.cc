@@ -0,0 +1,145 @@
+/*
+  sort.cc -- checks for ordering characters by usage
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Charset.h"
+#include "PaletteRegistry.h"
+#include "TextScreen.h"
+#include "test-utils.h"
+#include "utils.h"
+
+static void check_sorted_screen() {
+    auto rng = std::mt19937(6);
+    auto palette = PaletteRegistry::get("c64-colodore");
+    const size_t width = 16;
+    const size_t height = 8;
+
+    // Tiles are used with very different frequencies.
+    uint64_t tiles[12];
+    for (auto& tile : tiles) {
+        tile = random_tile(rng);
+    }
+    auto image = std::make_shared<Image>(width * 8, height * 8, palette);
+    for (size_t cell = 0; cell < width * height; cell++) {
+        auto tile = tiles[std::min(rng() % 12, rng() % 12)];
+        draw_tile(*image, cell % width, cell / width, tile, static_cast<uint8_t>(1 + rng() % 15), 0);
+    }
+
+    auto options = CharsetOptions();
+    options.sort_by_usage = true;
+    auto screen = TextScreen(ImageView(image), 0, options);
+    screen.save("sort");
+
+    auto charset = load_file("sort-charset.bin");
+    auto indices = load_file("sort-screen.bin");
+    auto colors = load_file("sort-colors.bin");
+
+    check(indices.size() == width * height && colors.size() == width * height, "wrong size of sorted screen");
+    if (indices.size() != width * height || colors.size() != width * height) {
+        return;
+    }
+
+    auto usage = std::vector<size_t>(charset.size() / 8);
+    for (size_t cell = 0; cell < width * height; cell++) {
+        check(cell_matches(*image, cell % width, cell / width, character(charset, indices[cell]), colors[cell], 0), "sorted cell " + std::to_string(cell) + " differs");
+        if (indices[cell] < usage.size()) {
+            usage[indices[cell]]++;
+        }
+    }
+    for (size_t index = 1; index < usage.size(); index++) {
+        check(usage[index - 1] >= usage[index], "character " + std::to_string(index) + " used more often than previous one");
+    }
+}
+
+
+static void check_mapping_is_permutation() {
+    auto rng = std::mt19937(7);
+    const size_t fixed = 8;
+
+    auto start = std::vector<uint8_t>(fixed * 8);
+    for (size_t index = 0; index < fixed; index++) {
+        auto tile = random_tile(rng);
+        memcpy(start.data() + index * 8, &tile, 8);
+    }
+
+    auto charset = Charset(start, Charset::unlimited);
+    uint64_t tiles[40];
+    for (auto& tile : tiles) {
+        tile = random_tile(rng);
+    }
+    for (size_t i = 0; i < 500; i++) {
+        auto tile = tiles[std::min(rng() % 40, rng() % 40)];
+        charset.add(reinterpret_cast<const uint8_t *>(&tile));
+    }
+
+    auto size = charset.get_size();
+    auto mapping = charset.sort_by_usage();
+    check(mapping.size() == size && charset.get_size() == size, "sorting changed number of characters");
+
+    auto seen = std::vector<bool>(size);
+    for (size_t index = 0; index < mapping.size(); index++) {
+        if (mapping[index] >= size || seen[mapping[index]]) {
+            check(false, "mapping is not a permutation at character " + std::to_string(index));
+            return;
+        }
+        seen[mapping[index]] = true;
+        if (index < fixed) {
+            check(mapping[index] == index, "start character " + std::to_string(index) + " moved");
+        }
+    }
+
+    // Characters are moved along with their indices.
+    charset.save("sort-permutation.bin");
+    auto data = load_file("sort-permutation.bin");
+    for (size_t i = 0; i < 40; i++) {
+        auto found = charset.find(reinterpret_cast<const uint8_t *>(&tiles[i]));
+        if (found) {
+            check(character(data, *found) == tiles[i], "tile " + std::to_string(i) + " not found at its new index");
+        }
+    }
+}
+
+
+int main() {
+    return run_checks([] {
+        check_sorted_screen();
+        check_mapping_is_permutation();
+    });
+}
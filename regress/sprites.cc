@@ -0,0 +1,113 @@
+/*
+  sprites.cc -- round trip checks for deduplicated sprites
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "PaletteRegistry.h"
+#include "SpriteSheet.h"
+#include "test-utils.h"
+#include "utils.h"
+
+// Sprite pixels as 63 bytes, 3 bytes per row, leftmost pixel in most significant bit.
+using Sprite = std::vector<uint8_t>;
+
+static void draw_sprite(Image& image, size_t sprite_x, size_t sprite_y, const Sprite& sprite, uint8_t color) {
+    for (size_t y = 0; y < 21; y++) {
+        for (size_t x = 0; x < 24; x++) {
+            image.set(sprite_x * 24 + x, sprite_y * 21 + y, (sprite[y * 3 + x / 8] & (0x80 >> (x % 8))) ? color : 0);
+        }
+    }
+}
+
+
+static void check_deduplicated_sprites() {
+    auto rng = std::mt19937(15);
+    auto palette = PaletteRegistry::get("c64-colodore");
+    const size_t columns = 4;
+    const size_t rows = 3;
+
+    auto shapes = std::vector<Sprite>(3, Sprite(63));
+    for (auto& shape : shapes) {
+        for (auto& byte : shape) {
+            byte = static_cast<uint8_t>(rng());
+        }
+    }
+    auto empty = Sprite(63, 0);
+
+    // Shape and color of each cell, shape 3 is empty.
+    const size_t cell_shapes[] = {0, 3, 1, 0, 2, 0, 3, 1, 1, 3, 2, 0};
+    const uint8_t cell_colors[] = {1, 1, 2, 1, 3, 5, 1, 2, 2, 1, 3, 1};
+    // Expected index of each cell: same shape in other color is a different sprite.
+    const uint8_t expected[] = {0, 0xff, 1, 0, 2, 3, 0xff, 1, 1, 0xff, 2, 0};
+    const size_t distinct = 4;
+
+    auto image = std::make_shared<Image>(columns * 24, rows * 21, palette);
+    for (size_t cell = 0; cell < columns * rows; cell++) {
+        draw_sprite(*image, cell % columns, cell / columns, cell_shapes[cell] < 3 ? shapes[cell_shapes[cell]] : empty, cell_colors[cell]);
+    }
+
+    auto sheet = SpriteSheet(ImageView(image), 0);
+    sheet.save_deduplicated("sprites.bin", "sprites-index.bin");
+
+    auto sprites = load_file("sprites.bin");
+    auto indices = load_file("sprites-index.bin");
+
+    check(sprites.size() == distinct * 64, "wrong number of sprites");
+    check(indices.size() == columns * rows, "wrong size of index table");
+    if (indices.size() != columns * rows) {
+        return;
+    }
+    for (size_t cell = 0; cell < columns * rows; cell++) {
+        auto name = "cell " + std::to_string(cell);
+        check(indices[cell] == expected[cell], name + " has index " + std::to_string(indices[cell]));
+        if (indices[cell] == SpriteSheet::empty_sprite) {
+            continue;
+        }
+        if ((indices[cell] + 1) * 64 > sprites.size()) {
+            check(false, name + " uses sprite beyond sprites file");
+            continue;
+        }
+        auto sprite = sprites.begin() + indices[cell] * 64;
+        check(Sprite(sprite, sprite + 63) == shapes[cell_shapes[cell]], name + " has wrong pixels");
+        check(sprite[63] == cell_colors[cell], name + " has wrong color");
+    }
+}
+
+
+int main() {
+    return run_checks(check_deduplicated_sprites);
+}
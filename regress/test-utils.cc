@@ -0,0 +1,113 @@
+/*
+  test-utils.cc -- helpers for regression tests
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "test-utils.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Exception.h"
+
+static size_t failures = 0;
+
+void check(bool condition, const std::string& message) {
+    if (!condition) {
+        fprintf(stderr, "FAIL: %s\n", message.c_str());
+        failures += 1;
+    }
+}
+
+
+int run_checks(const std::function<void()>& checks) {
+    try {
+        checks();
+    }
+    catch (Exception const &ex) {
+        fprintf(stderr, "FAIL: %s\n", ex.what());
+        return 1;
+    }
+
+    return failures > 0 ? 1 : 0;
+}
+
+
+void run_program(const std::string& program, const std::vector<std::string>& arguments) {
+    auto command = "'" + program + "'";
+    for (const auto& argument : arguments) {
+        command += " '" + argument + "'";
+    }
+
+    if (std::system(command.c_str()) != 0) {
+        throw Exception("command failed: %s", command.c_str());
+    }
+}
+
+
+uint64_t character(const std::vector<uint8_t>& charset, size_t index) {
+    uint64_t value = 0;
+    if ((index + 1) * 8 <= charset.size()) {
+        memcpy(&value, charset.data() + index * 8, 8);
+    }
+    return value;
+}
+
+
+bool cell_matches(Image& image, size_t cell_x, size_t cell_y, uint64_t character, uint8_t foreground_color, uint8_t background_color) {
+    auto bytes = reinterpret_cast<const uint8_t *>(&character);
+    for (size_t y = 0; y < 8; y++) {
+        for (size_t x = 0; x < 8; x++) {
+            auto color = (bytes[y] & (0x80 >> x)) ? foreground_color : background_color;
+            if (image.get(cell_x * 8 + x, cell_y * 8 + y) != color) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+void draw_tile(Image& image, size_t cell_x, size_t cell_y, uint64_t tile, uint8_t foreground_color, uint8_t background_color) {
+    auto bytes = reinterpret_cast<const uint8_t *>(&tile);
+    for (size_t y = 0; y < 8; y++) {
+        for (size_t x = 0; x < 8; x++) {
+            image.set(cell_x * 8 + x, cell_y * 8 + y, (bytes[y] & (0x80 >> x)) ? foreground_color : background_color);
+        }
+    }
+}
+
+
+uint64_t random_tile(std::mt19937& rng) {
+    return (static_cast<uint64_t>(rng()) << 32) | rng();
+}
@@ -0,0 +1,60 @@
+/*
+  test-utils.h -- helpers for regression tests
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_TEST_UTILS_H
+#define HAD_TEST_UTILS_H
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Image.h"
+
+// Report failure if condition is false.
+void check(bool condition, const std::string& message);
+// Run checks, returns exit status for main().
+int run_checks(const std::function<void()>& checks);
+// Run program with arguments, throws Exception if it fails.
+void run_program(const std::string& program, const std::vector<std::string>& arguments);
+
+// Character index from charset data, 0 if index is out of range.
+uint64_t character(const std::vector<uint8_t>& charset, size_t index);
+// Whether character drawn with colors reproduces cell of image.
+bool cell_matches(Image& image, size_t cell_x, size_t cell_y, uint64_t character, uint8_t foreground_color, uint8_t background_color);
+void draw_tile(Image& image, size_t cell_x, size_t cell_y, uint64_t tile, uint8_t foreground_color, uint8_t background_color);
+uint64_t random_tile(std::mt19937& rng);
+
+#endif // HAD_TEST_UTILS_H
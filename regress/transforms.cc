@@ -0,0 +1,89 @@
+/*
+  transforms.cc -- round trip check for transformed characters
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "Charset.h"
+#include "PaletteRegistry.h"
+#include "TextScreen.h"
+#include "test-utils.h"
+#include "utils.h"
+
+static void check_transforms() {
+    auto rng = std::mt19937(2);
+    auto palette = PaletteRegistry::get("c64-colodore");
+    auto image = std::make_shared<Image>(80, 64, palette);
+
+    // Every cell is a transformed variant of one of a few tiles.
+    uint64_t tiles[8];
+    for (auto& tile : tiles) {
+        tile = random_tile(rng);
+    }
+    for (size_t y = 0; y < 8; y++) {
+        for (size_t x = 0; x < 10; x++) {
+            auto tile = Charset::transform(tiles[rng() % 8], static_cast<uint8_t>(rng() % 8));
+            draw_tile(*image, x, y, tile, static_cast<uint8_t>(1 + rng() % 15), 0);
+        }
+    }
+
+    auto options = CharsetOptions();
+    options.transforms = Charset::MIRROR | Charset::FLIP | Charset::INVERSE;
+    auto screen = TextScreen(ImageView(image), 0, options);
+    screen.save("transforms");
+
+    auto charset = load_file("transforms-charset.bin");
+    auto indices = load_file("transforms-screen.bin");
+    auto colors = load_file("transforms-colors.bin");
+    auto transforms = load_file("transforms-transforms.bin");
+
+    check(charset.size() <= 8 * 8, "transforms didn't reuse characters");
+    check(indices.size() == 80 && colors.size() == 80 && transforms.size() == 80, "wrong size of transformed screen");
+    if (indices.size() != 80 || colors.size() != 80 || transforms.size() != 80) {
+        return;
+    }
+    for (size_t y = 0; y < 8; y++) {
+        for (size_t x = 0; x < 10; x++) {
+            auto cell = y * 10 + x;
+            auto tile = Charset::transform(character(charset, indices[cell]), transforms[cell]);
+            check(cell_matches(*image, x, y, tile, colors[cell], 0), "transformed cell " + std::to_string(x) + "," + std::to_string(y) + " differs");
+        }
+    }
+}
+
+
+int main() {
+    return run_checks(check_transforms);
+}
@@ -0,0 +1,123 @@
+/*
+  wide-indices.cc -- checks for 16 bit screen indices
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Exception.h"
+#include "PaletteRegistry.h"
+#include "TextScreen.h"
+#include "test-utils.h"
+#include "utils.h"
+#include "write_png.h"
+
+static std::string program;
+
+static void check_wide_screen() {
+    auto rng = std::mt19937(9);
+    auto palette = PaletteRegistry::get("c64-colodore");
+    const size_t width = 20;
+    const size_t height = 15;
+
+    // Every cell has its own character, so indices go beyond 255.
+    auto image = std::make_shared<Image>(width * 8, height * 8, palette);
+    for (size_t cell = 0; cell < width * height; cell++) {
+        draw_tile(*image, cell % width, cell / width, random_tile(rng), 1, 0);
+    }
+    image_write_png("wide-screen.png", ImageView(image));
+
+    run_program(program, {"-b", "0", "--max-characters", "512", "screen", "", "wide-charset.bin", "wide-screen.png"});
+
+    auto charset = load_file("wide-charset.bin");
+    auto data = load_file("wide-screen.bin");
+
+    check(charset.size() == width * height * 8, "wrong size of charset");
+    check(data.size() == width * height * 2, "screen doesn't have 16 bit indices");
+    if (data.size() != width * height * 2) {
+        return;
+    }
+    size_t largest = 0;
+    for (size_t cell = 0; cell < width * height; cell++) {
+        size_t index = data[cell * 2] | (data[cell * 2 + 1] << 8);
+        largest = std::max(largest, index);
+        check(cell_matches(*image, cell % width, cell / width, character(charset, index), 1, 0), "cell " + std::to_string(cell) + " differs");
+    }
+    check(largest >= 256, "no index uses high byte");
+}
+
+
+static void check_text_limit() {
+    auto rng = std::mt19937(10);
+    auto palette = PaletteRegistry::get("c64-colodore");
+
+    auto image = std::make_shared<Image>(64, 32, palette);
+    for (size_t cell = 0; cell < 32; cell++) {
+        draw_tile(*image, cell % 8, cell / 8, random_tile(rng), 1, 0);
+    }
+
+    auto options = CharsetOptions();
+    options.max_characters = 16;
+    try {
+        auto screen = TextScreen(ImageView(image), 0, options);
+        check(false, "text screen exceeded --max-characters");
+    }
+    catch (Exception const &) {
+    }
+
+    options.max_characters = 300;
+    try {
+        auto screen = TextScreen(ImageView(image), 0, options);
+        check(false, "text screen accepted more than 256 characters");
+    }
+    catch (Exception const &) {
+    }
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s gfx-convert\n", argv[0]);
+        return 1;
+    }
+    program = argv[1];
+
+    return run_checks([] {
+        check_wide_screen();
+        check_text_limit();
+    });
+}
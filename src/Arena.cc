@@ -0,0 +1,81 @@
+/*
+  Arena.cc -- memory arena for per-job buffers
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+Arena::Scope::Scope(Arena& arena_) : arena(arena_), previous_resource(std::pmr::set_default_resource(&arena_)) { }
+
+Arena::Scope::~Scope() {
+    std::pmr::set_default_resource(previous_resource);
+    arena.reset();
+}
+
+
+Arena::Arena(size_t block_size_) : block_size(block_size_), current_block(0), offset(0) { }
+
+
+void Arena::reset() {
+    auto lock = std::lock_guard(mutex);
+
+    // Blocks are kept, not freed, so the next job of the same size doesn't allocate.
+    current_block = 0;
+    offset = 0;
+}
+
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+    auto lock = std::lock_guard(mutex);
+
+    while (current_block < blocks.size()) {
+        auto& block = blocks[current_block];
+        auto address = reinterpret_cast<uintptr_t>(block.data.get());
+        auto start = (address + offset + alignment - 1) / alignment * alignment - address;
+        if (start + bytes <= block.size) {
+            offset = start + bytes;
+            return block.data.get() + start;
+        }
+        current_block++;
+        offset = 0;
+    }
+
+    blocks.emplace_back(std::max(block_size, bytes + alignment));
+    current_block = blocks.size() - 1;
+    auto address = reinterpret_cast<uintptr_t>(blocks.back().data.get());
+    auto start = (address + alignment - 1) / alignment * alignment - address;
+    offset = start + bytes;
+    return blocks.back().data.get() + start;
+}
@@ -40,8 +40,8 @@
 Bitmap::Bitmap(size_t w, size_t h, Layout layout) : width(w), height(h), layout(layout), bitmap(width * height * 8, 0), screen(width, height) {
 }
 
-Bitmap::Bitmap(const std::shared_ptr<Image>& image, Layout layout, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color) : width(image->get_width() / 8), height(image->get_height() / 8), layout(layout), bitmap((width * height * 8), 0), screen(width, height) {
-    if (image->get_width() % 8 != 0 || image->get_height() % 8 != 0) {
+Bitmap::Bitmap(const ImageView& image, Layout layout, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color) : width(image.get_width() / 8), height(image.get_height() / 8), layout(layout), bitmap((width * height * 8), 0), screen(width, height) {
+    if (image.get_width() % 8 != 0 || image.get_height() % 8 != 0) {
         throw Exception("image dimensions not multiple of 8");
     }
     if (layout == SPECTRUM && (width != 32 || height != 24)) {
@@ -55,17 +55,27 @@ Bitmap::Bitmap(const std::shared_ptr<Image>& image, Layout layout, std::optional
             
             uint8_t tile[8];
             
-            for (size_t tile_y = 0; tile_y < 8; tile_y++) {
-                tile[tile_y] = image->get_byte(screen_x * 8, screen_y * 8 + tile_y, bg_color, fg_color);
+            auto status = image.encode_tile(screen_x * 8, screen_y * 8, 8, 8, bg_color, fg_color, tile);
+            if (status.ok()) {
+                status = store_tile(screen_x, screen_y, tile, bg_color ? *bg_color : 0, fg_color ? *fg_color : 0);
+            }
+            if (!status.ok()) {
+                throw status.exception();
             }
-            
-            set_tile(screen_x, screen_y, tile, bg_color ? *bg_color : 0, fg_color ? *fg_color : 0);
         }
     }
 }
 
 
 void Bitmap::set_tile(size_t x, size_t y, const uint8_t tile[], uint8_t foreground_color, uint8_t background_color) {
+    auto status = store_tile(x, y, tile, foreground_color, background_color);
+    if (!status.ok()) {
+        throw status.exception();
+    }
+}
+
+
+Status Bitmap::store_tile(size_t x, size_t y, const uint8_t tile[], uint8_t foreground_color, uint8_t background_color) {
     switch (layout) {
         case C64:
             memcpy(bitmap.data() + (y * width + x) * 8, tile, 8);
@@ -74,7 +84,7 @@ void Bitmap::set_tile(size_t x, size_t y, const uint8_t tile[], uint8_t foregrou
 
         case SPECTRUM: {
             if ((foreground_color & 0x8) != (background_color & 0x8) && foreground_color != 0 && background_color != 0) {
-                throw Exception("mixing dark and bright colors").set_position(x, y);
+                return {Status::MIXED_BRIGHTNESS, x, y};
             }
             for (size_t tile_y = 0; tile_y < 8; tile_y++) {
                 size_t part = y / 8;
@@ -87,6 +97,8 @@ void Bitmap::set_tile(size_t x, size_t y, const uint8_t tile[], uint8_t foregrou
         }
 
     }
+
+    return {};
 }
 
 
@@ -35,8 +35,9 @@
 #ifndef HAD_BITMAP_H
 #define HAD_BITMAP_H
 
-#include "Image.h"
+#include "ImageView.h"
 #include "Matrix.h"
+#include "Status.h"
 
 class Bitmap {
 public:
@@ -45,7 +46,7 @@ public:
         SPECTRUM
     };
     Bitmap(size_t width, size_t height, Layout layout);
-    Bitmap(const std::shared_ptr<Image>& image, Layout layout, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color);
+    Bitmap(const ImageView& image, Layout layout, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color);
     
     [[nodiscard]] size_t get_width() const { return width; }
     [[nodiscard]] size_t get_height() const { return height; }
@@ -57,12 +58,14 @@ public:
     
 
 private:
+    Status store_tile(size_t x, size_t y, const uint8_t tile[], uint8_t foreground_color, uint8_t background_color);
+
     size_t width;
     size_t height;
     Layout layout;
 
 public:
-    std::vector<uint8_t> bitmap;
+    std::pmr::vector<uint8_t> bitmap;
     Matrix screen;
 };
 
@@ -0,0 +1,105 @@
+/*
+  CellIndex.cc -- colors used in cells of an image
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "CellIndex.h"
+
+#include <bitset>
+
+#include "Exception.h"
+#include "Image.h"
+#include "utils.h"
+
+size_t CellIndex::Cell::count() const {
+    return std::bitset<16>(colors).count();
+}
+
+
+CellIndex::CellIndex(const Image& image, size_t cell_width, size_t cell_height) : cell_width(cell_width), cell_height(cell_height), columns(image.get_width() / cell_width), rows(image.get_height() / cell_height), cells(columns * rows) {
+    const auto& palette = *image.get_palette();
+    if (!supports(palette)) {
+        throw Exception("cell index needs palette with at most 16 colors");
+    }
+    if (cell_width * cell_height > UINT16_MAX) {
+        throw Exception("cell size too large");
+    }
+    auto transparent_index = palette.transparent_index;
+
+    parallel_for(rows, [&](size_t begin, size_t end) {
+        auto row = std::vector<uint8_t>(image.get_width());
+        // 16 colors, transparency counted in last entry.
+        auto counts = std::vector<uint16_t>(columns * 17);
+
+        for (size_t cell_y = begin; cell_y < end; cell_y++) {
+            std::fill(counts.begin(), counts.end(), 0);
+            for (size_t y = 0; y < cell_height; y++) {
+                image.get_row(cell_y * cell_height + y, row.data());
+                for (size_t cell_x = 0; cell_x < columns; cell_x++) {
+                    auto cell_counts = counts.data() + cell_x * 17;
+                    auto pixels = row.data() + cell_x * cell_width;
+                    for (size_t x = 0; x < cell_width; x++) {
+                        cell_counts[pixels[x] == transparent_index ? 16 : pixels[x] & 0xf] += 1;
+                    }
+                }
+            }
+
+            for (size_t cell_x = 0; cell_x < columns; cell_x++) {
+                auto cell_counts = counts.data() + cell_x * 17;
+                auto& cell = cells[cell_y * columns + cell_x];
+                cell.has_transparency = cell_counts[16] > 0;
+                for (size_t color = 0; color < 16; color++) {
+                    auto count = cell_counts[color];
+                    if (count == 0) {
+                        continue;
+                    }
+                    cell.colors |= static_cast<uint16_t>(1 << color);
+                    if (count > cell.dominant_count[0]) {
+                        cell.dominant[1] = cell.dominant[0];
+                        cell.dominant_count[1] = cell.dominant_count[0];
+                        cell.dominant[0] = static_cast<uint8_t>(color);
+                        cell.dominant_count[0] = count;
+                    }
+                    else if (count > cell.dominant_count[1]) {
+                        cell.dominant[1] = static_cast<uint8_t>(color);
+                        cell.dominant_count[1] = count;
+                    }
+                }
+            }
+        }
+    });
+}
+
+
+bool CellIndex::supports(const Palette& palette) {
+    return palette.size() <= 16;
+}
@@ -0,0 +1,81 @@
+/*
+  CellIndex.h -- colors used in cells of an image
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_CELL_INDEX_H
+#define HAD_CELL_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Image;
+class Palette;
+
+// Colors used in each cell of an image, for palettes of up to 16 colors.
+class CellIndex {
+public:
+    class Cell {
+    public:
+        // Bit i is set if color i is used.
+        uint16_t colors = 0;
+        bool has_transparency = false;
+        // The two most used colors, most used first, and their pixel counts.
+        uint8_t dominant[2]{};
+        uint16_t dominant_count[2]{};
+
+        [[nodiscard]] size_t count() const;
+        [[nodiscard]] bool is_empty() const { return colors == 0; }
+        [[nodiscard]] bool is_single_color() const { return count() == 1; }
+    };
+
+    CellIndex(const Image& image, size_t cell_width, size_t cell_height);
+
+    [[nodiscard]] static bool supports(const Palette& palette);
+
+    [[nodiscard]] size_t get_cell_width() const { return cell_width; }
+    [[nodiscard]] size_t get_cell_height() const { return cell_height; }
+    [[nodiscard]] size_t get_columns() const { return columns; }
+    [[nodiscard]] size_t get_rows() const { return rows; }
+
+    [[nodiscard]] const Cell& get(size_t cell_x, size_t cell_y) const { return cells[cell_y * columns + cell_x]; }
+
+private:
+    size_t cell_width;
+    size_t cell_height;
+    size_t columns;
+    size_t rows;
+    std::vector<Cell> cells;
+};
+
+#endif // HAD_CELL_INDEX_H
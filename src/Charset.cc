@@ -34,15 +34,21 @@
 
 #include "Charset.h"
 
+#include <algorithm>
+#include <array>
+#include <bitset>
 #include <cstring>
+#include <numeric>
+#include <queue>
+#include <unordered_set>
 
 #include "Exception.h"
 #include "utils.h"
 
-Charset::Charset(size_t max_chars) : nchars(0), data(max_chars * 8, 0), max_chars(max_chars) {
+Charset::Charset(size_t max_chars) : nchars(0), max_chars(max_chars) {
 }
 
-Charset::Charset(std::vector<uint8_t> data_, size_t max_chars) : data(std::move(data_)), max_chars(max_chars) {
+Charset::Charset(const std::vector<uint8_t>& data_, size_t max_chars) : data(data_.begin(), data_.end()), nchars(0), max_chars(max_chars) {
     if (data.size() % 8 != 0) {
         throw Exception("charset data not multiple of 8 bytes");
     }
@@ -55,9 +61,7 @@ Charset::Charset(std::vector<uint8_t> data_, size_t max_chars) : data(std::move(
     for (auto i = 0; i < data.size() / 8; i++) {
         auto c = reinterpret_cast<const uint64_t *>(data.data())[i];
         if (c != 0 || !had_empty) {
-            if (chars.find(c) == chars.end()) {
-                chars[c] = i;
-            }
+            chars.insert(c, i);
             nchars = i + 1;
             if (c == 0) {
                 had_empty = true;
@@ -65,40 +69,421 @@ Charset::Charset(std::vector<uint8_t> data_, size_t max_chars) : data(std::move(
         }
     }
 
-    data.resize(max_chars * 8, 0);
+    nfixed = nchars;
+    usage.resize(nchars, 0);
 }
 
 size_t Charset::add(const uint8_t tile[]) {
     auto c = *reinterpret_cast<const uint64_t *>(tile);
-    auto it = chars.find(c);
+    auto index = chars.find(c);
     
-    if (it != chars.end()) {
-        return it->second;
+    if (index) {
+        usage[*index]++;
+        return *index;
     }
-    
+
+    return add_new(c);
+}
+
+size_t Charset::add(const uint8_t *tile, uint8_t& transform) {
+    auto c = *reinterpret_cast<const uint64_t *>(tile);
+    auto index = chars.find(c);
+
+    transform = 0;
+    if (index) {
+        usage[*index]++;
+        return *index;
+    }
+
+    if (allowed_transforms != 0) {
+        uint8_t canonical_transform;
+        auto entry = canonical_chars.find(canonical(c, canonical_transform));
+        if (entry) {
+            // All transforms are their own inverse and commute.
+            transform = canonical_transform ^ (*entry & 7);
+            usage[*entry >> 3]++;
+            return *entry >> 3;
+        }
+    }
+
+    return add_new(c);
+}
+
+size_t Charset::add_new(uint64_t tile) {
     if (nchars == max_chars) {
         throw Exception("out of characters");
     }
     
     auto index = nchars;
-    memcpy(data.data() + index * 8, tile, 8);
-    chars[c] = index;
+    if (data.size() < (index + 1) * 8) {
+        data.resize((index + 1) * 8);
+    }
+    memcpy(data.data() + index * 8, &tile, 8);
+    chars.insert(tile, index);
+    if (allowed_transforms != 0) {
+        uint8_t transform;
+        auto canonical_tile = canonical(tile, transform);
+        canonical_chars.insert(canonical_tile, index * 8 + transform);
+    }
+    usage.push_back(1);
     nchars++;
     return index;
 }
 
-std::optional<size_t> Charset::find(const uint8_t *tile) {
+std::optional<size_t> Charset::find(const uint8_t *tile) const {
     auto c = *reinterpret_cast<const uint64_t *>(tile);
-    auto it = chars.find(c);
+    auto index = chars.find(c);
     
-    if (it != chars.end()) {
-        return it->second;
+    if (index) {
+        return *index;
+    }
+
+    if (allowed_transforms != 0) {
+        uint8_t transform;
+        auto entry = canonical_chars.find(canonical(c, transform));
+        if (entry) {
+            return *entry >> 3;
+        }
     }
 
     return {};
 }
 
 
+size_t Charset::missing(const uint8_t *tiles, size_t count) const {
+    auto new_chars = std::unordered_set<uint64_t>();
+
+    for (size_t i = 0; i < count; i++) {
+        if (find(tiles + i * 8)) {
+            continue;
+        }
+        auto c = *reinterpret_cast<const uint64_t *>(tiles + i * 8);
+        uint8_t transform;
+        new_chars.insert(allowed_transforms != 0 ? canonical(c, transform) : c);
+    }
+
+    return new_chars.size();
+}
+
+
+void Charset::set_transforms(uint8_t transforms) {
+    allowed_transforms = transforms;
+    canonical_chars.clear();
+    if (allowed_transforms != 0) {
+        for (size_t index = 0; index < nchars; index++) {
+            uint64_t tile;
+            memcpy(&tile, data.data() + index * 8, 8);
+            uint8_t transform;
+            auto canonical_tile = canonical(tile, transform);
+            canonical_chars.insert(canonical_tile, index * 8 + transform);
+        }
+    }
+}
+
+
+uint8_t Charset::transforms(const std::string& names) {
+    uint8_t transforms = 0;
+
+    for (auto name : names) {
+        switch (name) {
+            case 'x':
+                transforms |= MIRROR;
+                break;
+
+            case 'y':
+                transforms |= FLIP;
+                break;
+
+            case 'i':
+                transforms |= INVERSE;
+                break;
+
+            default:
+                throw Exception("unknown transform '%c'", name);
+        }
+    }
+
+    return transforms;
+}
+
+
+static std::array<uint8_t, 256> make_reversed_bytes() {
+    auto table = std::array<uint8_t, 256>();
+    for (size_t byte = 0; byte < 256; byte++) {
+        uint8_t reversed = 0;
+        for (size_t bit = 0; bit < 8; bit++) {
+            if (byte & (1 << bit)) {
+                reversed |= 0x80 >> bit;
+            }
+        }
+        table[byte] = reversed;
+    }
+    return table;
+}
+
+static const auto reversed_bytes = make_reversed_bytes();
+
+uint64_t Charset::transform(uint64_t tile, uint8_t transform) {
+    uint8_t bytes[8];
+    memcpy(bytes, &tile, 8);
+
+    if (transform & MIRROR) {
+        for (auto& byte : bytes) {
+            byte = reversed_bytes[byte];
+        }
+    }
+    if (transform & FLIP) {
+        std::reverse(bytes, bytes + 8);
+    }
+
+    memcpy(&tile, bytes, 8);
+    return transform & INVERSE ? ~tile : tile;
+}
+
+
+// Smallest of all allowed transforms of tile, transform is set to the transform that produces it.
+uint64_t Charset::canonical(uint64_t tile, uint8_t& transform) const {
+    auto best = tile;
+    transform = 0;
+
+    for (uint8_t candidate = 1; candidate < 8; candidate++) {
+        if ((candidate & ~allowed_transforms) != 0) {
+            continue;
+        }
+        auto transformed = Charset::transform(tile, candidate);
+        if (transformed < best) {
+            best = transformed;
+            transform = candidate;
+        }
+    }
+
+    return best;
+}
+
+
+std::vector<size_t> Charset::reduce(size_t new_max_chars) {
+    if (nfixed > new_max_chars) {
+        throw Exception("start charset has more than %zu characters", new_max_chars);
+    }
+
+    auto tiles = std::vector<uint64_t>(nchars);
+    memcpy(tiles.data(), data.data(), nchars * 8);
+
+    // Merged characters point to the character they were merged into, remaining ones to themselves.
+    auto merged_into = std::vector<size_t>(nchars);
+    auto nearest = std::vector<size_t>(nchars);
+    auto distance = std::vector<size_t>(nchars);
+    // Characters whose nearest character was found to be index, may contain stale entries.
+    auto nearest_of = std::vector<std::vector<size_t>>(nchars);
+    // Remaining characters in increasing order, compacted when many of them have been merged.
+    auto active = std::vector<size_t>(nchars);
+
+    // Closest characters found by the last full search, as (distance, index) in increasing order.
+    // Merging only removes characters, so these stay the closest ones and the next remaining one is the new nearest.
+    constexpr size_t cached_neighbors = 8;
+    auto neighbors = std::vector<std::pair<size_t, size_t>>(nchars * cached_neighbors);
+    auto neighbors_begin = std::vector<size_t>(nchars);
+    auto neighbors_end = std::vector<size_t>(nchars);
+
+    auto find_nearest = [&](size_t index) {
+        auto cached = neighbors.data() + index * cached_neighbors;
+        for (auto& i = neighbors_begin[index]; i < neighbors_end[index]; i++) {
+            if (merged_into[cached[i].second] == cached[i].second) {
+                distance[index] = cached[i].first;
+                nearest[index] = cached[i].second;
+                return;
+            }
+        }
+
+        // Characters are visited in increasing order, so ties keep the lowest index.
+        size_t found = 0;
+        for (auto other : active) {
+            if (other == index || merged_into[other] != other) {
+                continue;
+            }
+            auto d = std::bitset<64>(tiles[index] ^ tiles[other]).count();
+            if (found < cached_neighbors || d < cached[found - 1].first) {
+                auto position = std::min(found, cached_neighbors - 1);
+                while (position > 0 && cached[position - 1].first > d) {
+                    cached[position] = cached[position - 1];
+                    position--;
+                }
+                cached[position] = {d, other};
+                found = std::min(found + 1, cached_neighbors);
+            }
+        }
+        if (found == 0) {
+            nearest[index] = index;
+            distance[index] = SIZE_MAX;
+            neighbors_begin[index] = neighbors_end[index] = 0;
+            return;
+        }
+
+        nearest[index] = cached[0].second;
+        distance[index] = cached[0].first;
+        // Characters at the largest distance may not all have been kept, so only those closer are known to be complete.
+        auto end = found;
+        if (found == cached_neighbors) {
+            while (end > 1 && cached[end - 1].first == cached[found - 1].first) {
+                end--;
+            }
+        }
+        neighbors_begin[index] = 1;
+        neighbors_end[index] = end;
+    };
+    // Find nearest characters of indices, in parallel if there is enough work.
+    auto find_all_nearest = [&](const std::vector<size_t>& indices) {
+        if (indices.size() * active.size() < 64 * 1024) {
+            for (auto index : indices) {
+                find_nearest(index);
+            }
+        }
+        else {
+            parallel_for(indices.size(), [&](size_t begin, size_t end) {
+                for (auto i = begin; i < end; i++) {
+                    find_nearest(indices[i]);
+                }
+            });
+        }
+    };
+
+    auto cost = [&](size_t index) {
+        return distance[index] * std::max(usage[index], size_t{1});
+    };
+    // Candidates for merging by cost, lowest first; entries whose cost has changed since are skipped.
+    typedef std::pair<size_t, size_t> Candidate;
+    auto candidates = std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>>();
+    auto add_candidates = [&](const std::vector<size_t>& indices) {
+        for (auto index : indices) {
+            nearest_of[nearest[index]].push_back(index);
+            candidates.emplace(cost(index), index);
+        }
+    };
+
+    for (size_t index = 0; index < nchars; index++) {
+        merged_into[index] = index;
+        active[index] = index;
+    }
+
+    auto remaining = nchars;
+    if (remaining > new_max_chars) {
+        auto indices = std::vector<size_t>(nchars - nfixed);
+        std::iota(indices.begin(), indices.end(), nfixed);
+        find_all_nearest(indices);
+        add_candidates(indices);
+    }
+
+    while (remaining > new_max_chars) {
+        // Merge the character whose replacement changes the fewest pixels on screen.
+        auto [victim_cost, victim] = candidates.top();
+        candidates.pop();
+        if (merged_into[victim] != victim || victim_cost != cost(victim)) {
+            continue;
+        }
+
+        auto target = nearest[victim];
+        merged_into[victim] = target;
+        usage[target] += usage[victim];
+        remaining--;
+        if (target >= nfixed) {
+            candidates.emplace(cost(target), target);
+        }
+
+        if (remaining * 2 < active.size()) {
+            active.erase(std::remove_if(active.begin(), active.end(), [&](size_t index) { return merged_into[index] != index; }), active.end());
+        }
+
+        auto orphans = std::vector<size_t>();
+        for (auto index : nearest_of[victim]) {
+            if (merged_into[index] == index && nearest[index] == victim) {
+                orphans.push_back(index);
+            }
+        }
+        nearest_of[victim] = {};
+        std::sort(orphans.begin(), orphans.end());
+        orphans.erase(std::unique(orphans.begin(), orphans.end()), orphans.end());
+        find_all_nearest(orphans);
+        add_candidates(orphans);
+    }
+
+    auto mapping = std::vector<size_t>(nchars);
+    size_t new_index = 0;
+    for (size_t index = 0; index < nchars; index++) {
+        if (merged_into[index] == index) {
+            mapping[index] = new_index;
+            memcpy(data.data() + new_index * 8, &tiles[index], 8);
+            usage[new_index] = usage[index];
+            new_index++;
+        }
+    }
+    for (size_t index = 0; index < nchars; index++) {
+        auto representative = index;
+        while (merged_into[representative] != representative) {
+            representative = merged_into[representative];
+        }
+        mapping[index] = mapping[representative];
+    }
+    chars.update_values([&mapping](uint32_t index) { return mapping[index]; });
+    canonical_chars.update_values([&mapping](uint32_t entry) { return mapping[entry >> 3] * 8 + (entry & 7); });
+
+    nchars = remaining;
+    max_chars = new_max_chars;
+    data.resize(nchars * 8);
+    usage.resize(nchars);
+
+    return mapping;
+}
+
+
+std::vector<size_t> Charset::sort_by_usage() {
+    auto order = std::vector<size_t>(nchars - nfixed);
+    std::iota(order.begin(), order.end(), nfixed);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return usage[a] > usage[b]; });
+
+    auto mapping = std::vector<size_t>(nchars);
+    std::iota(mapping.begin(), mapping.begin() + nfixed, 0);
+    for (size_t i = 0; i < order.size(); i++) {
+        mapping[order[i]] = nfixed + i;
+    }
+
+    auto old_data = std::vector<uint8_t>(data.begin(), data.begin() + nchars * 8);
+    auto old_usage = std::vector<size_t>(usage.begin(), usage.end());
+    for (size_t index = nfixed; index < nchars; index++) {
+        memcpy(data.data() + mapping[index] * 8, old_data.data() + index * 8, 8);
+        usage[mapping[index]] = old_usage[index];
+    }
+    chars.update_values([&mapping](uint32_t index) { return mapping[index]; });
+    canonical_chars.update_values([&mapping](uint32_t entry) { return mapping[entry >> 3] * 8 + (entry & 7); });
+
+    return mapping;
+}
+
+
+std::vector<size_t> Charset::finish(const CharsetOptions& options) {
+    auto mapping = std::vector<size_t>(nchars);
+    std::iota(mapping.begin(), mapping.end(), 0);
+
+    if (options.reduce) {
+        mapping = reduce(options.max_characters);
+    }
+    if (options.sort_by_usage) {
+        auto order = sort_by_usage();
+        for (auto& index : mapping) {
+            index = order[index];
+        }
+    }
+
+    return mapping;
+}
+
+
 void Charset::save(const std::string& file_name, bool full) const {
-    save_file(file_name, data.data(), (full ? max_chars : nchars) * 8);
+    if (full && data.size() < max_chars * 8) {
+        auto padded = std::vector<uint8_t>(data.begin(), data.end());
+        padded.resize(max_chars * 8, 0);
+        save_file(file_name, padded);
+    }
+    else {
+        save_file(file_name, data.data(), (full ? max_chars : nchars) * 8);
+    }
 }
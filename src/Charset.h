@@ -36,26 +36,83 @@
 #define HAD_CHARSET_H
 
 #include <cstdint>
+#include <memory_resource>
+#include <optional>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "TileIndex.h"
+
+// How charsets are built when converting images.
+class CharsetOptions {
+public:
+    // Number of characters available, screens use 16 bit indices if more than 256.
+    size_t max_characters = 256;
+    // Merge most similar characters if more than max_characters are needed.
+    bool reduce = false;
+    // Transforms of tiles that reuse existing characters.
+    uint8_t transforms = 0;
+    // Order characters by how often they are used, most used first.
+    bool sort_by_usage = false;
+};
+
 class Charset {
 public:
+    // Maximum for charsets that are reduced to their final size later.
+    static constexpr size_t unlimited = 0xffffffff;
+
+    // Transforms of characters that can be displayed without needing an extra character, can be combined.
+    static constexpr uint8_t MIRROR = 1; // swap left and right
+    static constexpr uint8_t FLIP = 2; // swap top and bottom
+    static constexpr uint8_t INVERSE = 4; // swap set and cleared pixels
+
+    // Parse transforms given as letters: 'x' for mirror, 'y' for flip, 'i' for inverse.
+    static uint8_t transforms(const std::string& names);
+    static uint64_t transform(uint64_t tile, uint8_t transform);
+
     explicit Charset(size_t max_chars = 256);
-    explicit Charset(std::vector<uint8_t> data, size_t max_chars = 256);
+    explicit Charset(const std::vector<uint8_t>& data, size_t max_chars = 256);
+
+    [[nodiscard]] size_t get_size() const { return nchars; }
+    [[nodiscard]] size_t get_max_chars() const { return max_chars; }
+    [[nodiscard]] uint8_t get_transforms() const { return allowed_transforms; }
+
+    // Allow reusing characters for transformed versions of them.
+    void set_transforms(uint8_t transforms);
 
     size_t add(const uint8_t *tile);
-    std::optional<size_t> find(const uint8_t *tile);
+    // Transform is set to what needs to be applied to the returned character to get tile.
+    size_t add(const uint8_t *tile, uint8_t& transform);
+    std::optional<size_t> find(const uint8_t *tile) const;
+    // Number of characters that would be added for count tiles.
+    [[nodiscard]] size_t missing(const uint8_t *tiles, size_t count) const;
+
+    // Merge most similar characters until at most max_chars remain, characters from start charset are kept.
+    // Returns new index for each old index.
+    std::vector<size_t> reduce(size_t max_chars);
+    // Order characters by usage, most used first, characters from start charset are kept.
+    // Returns new index for each old index.
+    std::vector<size_t> sort_by_usage();
+    // Reduce and sort as specified by options once all characters are added.
+    // Returns new index for each old index.
+    std::vector<size_t> finish(const CharsetOptions& options);
     
     void save(const std::string& file_name, bool full = false) const;
     
 private:
-    std::vector<uint8_t> data;
+    std::pmr::vector<uint8_t> data;
     size_t nchars;
+    size_t nfixed = 0;
     size_t max_chars;
+    std::pmr::vector<size_t> usage;
     
-    std::unordered_map<uint64_t, size_t> chars;
+    TileIndex chars;
+    uint8_t allowed_transforms = 0;
+    // Canonical form of characters -> index * 8 + transform from canonical form to character.
+    TileIndex canonical_chars;
+
+    uint64_t canonical(uint64_t tile, uint8_t& transform) const;
+    size_t add_new(uint64_t tile);
 };
 
 #endif // HAD_CHARSET_H
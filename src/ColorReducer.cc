@@ -0,0 +1,230 @@
+/*
+  ColorReducer.cc -- reduce cells to colors they can hold
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ColorReducer.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "Exception.h"
+#include "utils.h"
+
+ColorReducer::ColorReducer(size_t cell_width, size_t cell_height, std::optional<uint8_t> background_color, bool spectrum_brightness, size_t colors_per_cell) : cell_width(cell_width), cell_height(cell_height), background_color(background_color), spectrum_brightness(spectrum_brightness), colors_per_cell(colors_per_cell) {
+    if (colors_per_cell < 2 || colors_per_cell > max_colors_per_cell) {
+        throw Exception("unsupported number of colors per cell %zu", colors_per_cell);
+    }
+}
+
+
+void ColorReducer::set_shared_colors(std::vector<uint8_t> colors, size_t own_color_limit_) {
+    if (colors.size() + (background_color ? 1 : 0) >= colors_per_cell) {
+        throw Exception("too many shared colors");
+    }
+    shared_colors = std::move(colors);
+    own_color_limit = own_color_limit_;
+}
+
+
+size_t ColorReducer::reduce(const ImageView& image) const {
+    return reduce(image, Histogram(image, cell_width, cell_height));
+}
+
+
+size_t ColorReducer::reduce(const ImageView& image, const Histogram& histogram) const {
+    if (histogram.get_cell_width() != cell_width || histogram.get_cell_height() != cell_height) {
+        throw Exception("histogram cell size doesn't match");
+    }
+
+    const auto& palette = *image.get_image()->get_palette();
+    auto columns = histogram.get_columns();
+    auto rows = histogram.get_rows();
+
+    // Perceptual distance between all pairs of palette colors.
+    auto distances = std::vector<float>(palette.size() * palette.size());
+    for (size_t i = 0; i < palette.size(); i++) {
+        for (size_t j = 0; j < palette.size(); j++) {
+            distances[i * palette.size() + j] = palette.get_lab(i).distance(palette.get_lab(j));
+        }
+    }
+
+    auto choices = std::vector<Choice>(columns * rows);
+
+    parallel_for(rows, [&](size_t begin, size_t end) {
+        for (size_t cell_y = begin; cell_y < end; cell_y++) {
+            for (size_t cell_x = 0; cell_x < columns; cell_x++) {
+                auto choice = choose(histogram, cell_x, cell_y, palette, distances);
+                if (choice.changed && choice.ncolors == 0) {
+                    throw Exception("no allowed combination of colors for cell").set_position(image.get_x_offset() + cell_x * cell_width, image.get_y_offset() + cell_y * cell_height);
+                }
+                choices[cell_y * columns + cell_x] = choice;
+            }
+        }
+    });
+
+    // Pixels of different cells may share bytes in the image, so remap them sequentially.
+    auto target = image.get_image();
+    size_t changed = 0;
+    for (size_t index = 0; index < choices.size(); index++) {
+        const auto& choice = choices[index];
+        if (!choice.changed) {
+            continue;
+        }
+        changed += 1;
+
+        auto x_offset = image.get_x_offset() + (index % columns) * cell_width;
+        auto y_offset = image.get_y_offset() + (index / columns) * cell_height;
+        for (size_t y = y_offset; y < y_offset + cell_height; y++) {
+            for (size_t x = x_offset; x < x_offset + cell_width; x++) {
+                auto color = target->get(x, y);
+                if (color == palette.transparent_index) {
+                    continue;
+                }
+                auto best = choice.colors[0];
+                for (size_t i = 1; i < choice.ncolors; i++) {
+                    if (distances[color * palette.size() + choice.colors[i]] < distances[color * palette.size() + best]) {
+                        best = choice.colors[i];
+                    }
+                }
+                target->set(x, y, best);
+            }
+        }
+    }
+
+    return changed;
+}
+
+
+ColorReducer::Choice ColorReducer::choose(const Histogram& histogram, size_t cell_x, size_t cell_y, const Palette& palette, const std::vector<float>& distances) const {
+    // Colors every cell can use, background color isn't available if it's not in the palette.
+    auto fixed = shared_colors;
+    if (background_color && *background_color < palette.size()) {
+        fixed.push_back(*background_color);
+    }
+    auto is_fixed = [&](size_t color) {
+        return color == background_color || std::find(shared_colors.begin(), shared_colors.end(), color) != shared_colors.end();
+    };
+
+    auto colors = std::vector<uint8_t>();
+    auto own_colors_usable = true;
+    for (size_t color = 0; color < palette.size(); color++) {
+        if (color != palette.transparent_index && !is_fixed(color) && histogram.get(cell_x, cell_y, static_cast<uint8_t>(color)) > 0) {
+            colors.push_back(static_cast<uint8_t>(color));
+            if (color >= own_color_limit) {
+                own_colors_usable = false;
+            }
+        }
+    }
+
+    auto available = colors_per_cell - shared_colors.size() - (background_color ? 1 : 0);
+    auto kept = colors;
+    kept.insert(kept.end(), fixed.begin(), fixed.end());
+    if (colors.size() <= available && own_colors_usable && allowed(kept.data(), kept.size())) {
+        return {};
+    }
+
+    // Search all combinations for small palettes, only colors in cell for large ones.
+    auto candidates = std::vector<uint8_t>();
+    for (size_t color = 0; color < palette.size(); color++) {
+        if (color != palette.transparent_index && !is_fixed(color) && color < own_color_limit && (palette.size() <= 16 || histogram.get(cell_x, cell_y, static_cast<uint8_t>(color)) > 0)) {
+            candidates.push_back(static_cast<uint8_t>(color));
+        }
+    }
+    available = std::min(available, candidates.size());
+
+    auto choice = Choice();
+    choice.changed = true;
+    auto best_error = std::numeric_limits<float>::max();
+
+    // Current combination: indices into candidates in increasing order, followed by fixed colors.
+    size_t selected[max_colors_per_cell];
+    uint8_t combination[max_colors_per_cell];
+    auto ncolors = available + fixed.size();
+    std::copy(fixed.begin(), fixed.end(), combination + available);
+    for (size_t i = 0; i < available; i++) {
+        selected[i] = i;
+    }
+
+    while (true) {
+        for (size_t i = 0; i < available; i++) {
+            combination[i] = candidates[selected[i]];
+        }
+        if (allowed(combination, ncolors)) {
+            float error = 0;
+            for (auto color : colors) {
+                auto distance = std::numeric_limits<float>::max();
+                for (size_t i = 0; i < ncolors; i++) {
+                    distance = std::min(distance, distances[color * palette.size() + combination[i]]);
+                }
+                error += distance * static_cast<float>(histogram.get(cell_x, cell_y, color));
+            }
+            if (error < best_error) {
+                best_error = error;
+                std::copy(combination, combination + ncolors, choice.colors);
+                choice.ncolors = ncolors;
+            }
+        }
+
+        // Advance to next combination.
+        auto i = available;
+        while (i > 0 && selected[i - 1] == candidates.size() - available + i - 1) {
+            i -= 1;
+        }
+        if (i == 0) {
+            break;
+        }
+        selected[i - 1] += 1;
+        for (auto j = i; j < available; j++) {
+            selected[j] = selected[j - 1] + 1;
+        }
+    }
+
+    return choice;
+}
+
+
+bool ColorReducer::allowed(const uint8_t *colors, size_t ncolors) const {
+    for (size_t i = 0; i < ncolors; i++) {
+        for (size_t j = i + 1; j < ncolors; j++) {
+            if (!allowed(colors[i], colors[j])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+bool ColorReducer::allowed(uint8_t color_1, uint8_t color_2) const {
+    return !spectrum_brightness || (color_1 & 0x8) == (color_2 & 0x8) || color_1 == 0 || color_2 == 0;
+}
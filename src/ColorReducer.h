@@ -0,0 +1,82 @@
+/*
+  ColorReducer.h -- reduce cells to colors they can hold
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_COLOR_REDUCER_H
+#define HAD_COLOR_REDUCER_H
+
+#include <optional>
+#include <vector>
+
+#include "Histogram.h"
+#include "ImageView.h"
+
+class ColorReducer {
+public:
+    ColorReducer(size_t cell_width, size_t cell_height, std::optional<uint8_t> background_color = {}, bool spectrum_brightness = false, size_t colors_per_cell = 2);
+
+    // Colors all cells may use in addition to background color, and limit for the cell's own colors (for multicolor characters).
+    void set_shared_colors(std::vector<uint8_t> colors, size_t own_color_limit);
+
+    // Remap pixels of cells with too many colors to the set of colors (including background) that changes them least.
+    // Returns number of cells changed, throws if no allowed set of colors exists for a cell.
+    size_t reduce(const ImageView& image) const;
+    // Same, using already computed histogram of image for cell size.
+    size_t reduce(const ImageView& image, const Histogram& histogram) const;
+
+private:
+    static constexpr size_t max_colors_per_cell = 4;
+
+    class Choice {
+    public:
+        bool changed = false;
+        uint8_t colors[max_colors_per_cell]{};
+        size_t ncolors = 0;
+    };
+
+    [[nodiscard]] Choice choose(const Histogram& histogram, size_t cell_x, size_t cell_y, const Palette& palette, const std::vector<float>& distances) const;
+    [[nodiscard]] bool allowed(uint8_t color_1, uint8_t color_2) const;
+    [[nodiscard]] bool allowed(const uint8_t *colors, size_t ncolors) const;
+
+
+    size_t cell_width;
+    size_t cell_height;
+    std::optional<uint8_t> background_color;
+    // Don't mix bright and dark colors in one cell, as required by the Spectrum.
+    bool spectrum_brightness;
+    size_t colors_per_cell;
+    std::vector<uint8_t> shared_colors;
+    size_t own_color_limit = 256;
+};
+
+#endif // HAD_COLOR_REDUCER_H
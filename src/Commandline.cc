@@ -31,10 +31,15 @@
   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include "Commandline.h"
 
 #include <algorithm>
 #include <cctype>
+#include <cerrno>
 #include <sstream>
 #include <strings.h>
 #include <unordered_map>
@@ -47,6 +52,16 @@
 
 extern int optind;
 
+#ifndef HAVE_GETPROGNAME
+static const char *getprogname() {
+#ifdef __GLIBC__
+    return program_invocation_short_name;
+#else
+    return "gfx-convert";
+#endif
+}
+#endif
+
 Commandline::Commandline(std::vector<Option> options_, std::string arguments_, std::string header_, std::string footer_, std::string version_) : options(std::move(options_)), arguments(std::move(arguments_)), header(std::move(header_)), footer(std::move(footer_)), version(std::move(version_)), options_sorted(false) {
     add_option(Option("help", 'h', "display this help message"));
     add_option(Option("version", 'V', "display version number"));
@@ -0,0 +1,138 @@
+/*
+  CompressedFileWriter.cc -- compress and write files in background threads
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "CompressedFileWriter.h"
+
+#include "Cruncher.h"
+#include "Exception.h"
+#include "utils.h"
+
+CompressedFileWriter::CompressedFileWriter() {
+    for (size_t i = 0; i < parallel_threads(); i++) {
+        threads.emplace_back(&CompressedFileWriter::work, this);
+    }
+}
+
+
+CompressedFileWriter::~CompressedFileWriter() {
+    try {
+        finish();
+    }
+    catch (...) {
+        // Errors are only reported by an explicit finish().
+    }
+}
+
+
+void CompressedFileWriter::save(const std::string& file_name, const uint8_t* data, size_t length) {
+    auto lock = std::unique_lock<std::mutex>(mutex);
+
+    changed.wait(lock, [this, length] { return error || pending_size == 0 || pending_size + length <= max_pending_size; });
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    auto& pending = pending_files[file_name];
+    pending_size -= pending.size();
+    pending.assign(data, data + length);
+    pending_size += length;
+
+    changed.notify_all();
+}
+
+
+void CompressedFileWriter::finish() {
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        finishing = true;
+    }
+    changed.notify_all();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+
+void CompressedFileWriter::work() {
+    auto cruncher = Cruncher();
+    auto lock = std::unique_lock<std::mutex>(mutex);
+
+    while (true) {
+        auto it = pending_files.begin();
+        while (it != pending_files.end() && writing_files.find(it->first) != writing_files.end()) {
+            ++it;
+        }
+
+        if (it == pending_files.end()) {
+            if (finishing && pending_files.empty()) {
+                return;
+            }
+            changed.wait(lock);
+            continue;
+        }
+
+        auto file_name = it->first;
+        auto data = std::move(it->second);
+        pending_files.erase(it);
+        pending_size -= data.size();
+        writing_files.insert(file_name);
+        changed.notify_all();
+        lock.unlock();
+
+        auto write_error = std::exception_ptr();
+        try {
+            auto compressed = cruncher.crunch(data.data(), data.size());
+            auto fp = make_shared_file(file_name, "wb");
+            if (fwrite(compressed.data(), 1, compressed.size(), fp.get()) != compressed.size()) {
+                throw Exception("can't write '%s'", file_name.c_str()).append_system_error();
+            }
+        }
+        catch (...) {
+            write_error = std::current_exception();
+        }
+
+        lock.lock();
+        if (write_error && !error) {
+            error = write_error;
+        }
+        writing_files.erase(file_name);
+        changed.notify_all();
+    }
+}
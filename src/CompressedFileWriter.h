@@ -0,0 +1,77 @@
+/*
+  CompressedFileWriter.h -- compress and write files in background threads
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_COMPRESSED_FILE_WRITER_H
+#define HAD_COMPRESSED_FILE_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Compresses files and writes them in background threads while conversion continues.
+// Saving blocks while too much data is waiting, so memory use stays bounded.
+class CompressedFileWriter {
+public:
+    CompressedFileWriter();
+    ~CompressedFileWriter();
+
+    // Queue file for writing. A later save of the same file replaces one still waiting.
+    void save(const std::string& file_name, const uint8_t* data, size_t length);
+    // Wait until all files are written. Rethrows the first error from the background threads.
+    void finish();
+
+private:
+    static constexpr size_t max_pending_size = 16 * 1024 * 1024;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    // Files not yet picked up by a thread, keyed by name.
+    std::map<std::string, std::vector<uint8_t>> pending_files;
+    size_t pending_size = 0;
+    // Files currently being written; a newer version of one of them must wait until it is done.
+    std::set<std::string> writing_files;
+    bool finishing = false;
+    std::exception_ptr error;
+    std::vector<std::thread> threads;
+
+    void work();
+};
+
+#endif // HAD_COMPRESSED_FILE_WRITER_H
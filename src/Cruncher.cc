@@ -0,0 +1,153 @@
+/*
+  Cruncher.cc -- LZ4 compatible compression
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "Cruncher.h"
+
+#include <algorithm>
+#include <cstring>
+
+// LZ4 block format limits.
+static constexpr size_t min_match = 4;
+// The last 5 bytes are always literals.
+static constexpr size_t last_literals = 5;
+// No match may start within the last 12 bytes.
+static constexpr size_t match_limit = 12;
+static constexpr size_t max_offset = 65535;
+
+static constexpr size_t hash_bits = 16;
+// Number of candidates examined per position.
+static constexpr size_t max_chain = 256;
+
+static uint32_t read32(const uint8_t *data) {
+    uint32_t value;
+    memcpy(&value, data, 4);
+    return value;
+}
+
+static size_t hash(const uint8_t *data) {
+    return (read32(data) * 2654435761U) >> (32 - hash_bits);
+}
+
+static void append_length(std::vector<uint8_t>& output, size_t length) {
+    while (length >= 255) {
+        output.push_back(255);
+        length -= 255;
+    }
+    output.push_back(length);
+}
+
+static void append_sequence(std::vector<uint8_t>& output, const uint8_t *literals, size_t literal_length, size_t offset, size_t match_length) {
+    auto token = static_cast<uint8_t>(std::min(literal_length, size_t{15}) << 4);
+    if (match_length > 0) {
+        token |= std::min(match_length - min_match, size_t{15});
+    }
+    output.push_back(token);
+    if (literal_length >= 15) {
+        append_length(output, literal_length - 15);
+    }
+    output.insert(output.end(), literals, literals + literal_length);
+
+    if (match_length > 0) {
+        output.push_back(offset & 0xff);
+        output.push_back(offset >> 8);
+        if (match_length - min_match >= 15) {
+            append_length(output, match_length - min_match - 15);
+        }
+    }
+}
+
+
+Cruncher::Cruncher() : head(size_t{1} << hash_bits, none) {
+}
+
+
+void Cruncher::insert(const uint8_t *data, size_t position) {
+    auto h = hash(data + position);
+    previous[position] = head[h];
+    head[h] = position;
+}
+
+
+std::vector<uint8_t> Cruncher::crunch(const uint8_t *data, size_t length) {
+    auto output = std::vector<uint8_t>();
+    std::fill(head.begin(), head.end(), none);
+    previous.assign(length, none);
+
+    size_t anchor = 0;
+    size_t position = 0;
+
+    if (length > match_limit) {
+        auto limit = length - match_limit;
+        auto match_end_limit = length - last_literals;
+
+        while (position < limit) {
+            size_t best_length = 0;
+            size_t best_offset = 0;
+
+            auto candidate = head[hash(data + position)];
+            for (size_t chain = 0; candidate != none && position - candidate <= max_offset && chain < max_chain; chain++) {
+                // Check byte that would extend best match first, most candidates fail there.
+                if (data[candidate + best_length] == data[position + best_length] && read32(data + candidate) == read32(data + position)) {
+                    size_t match_length = min_match;
+                    while (position + match_length < match_end_limit && data[candidate + match_length] == data[position + match_length]) {
+                        match_length++;
+                    }
+                    if (match_length > best_length) {
+                        best_length = match_length;
+                        best_offset = position - candidate;
+                    }
+                }
+                candidate = previous[candidate];
+            }
+
+            insert(data, position);
+
+            if (best_length < min_match) {
+                position++;
+                continue;
+            }
+
+            append_sequence(output, data + anchor, position - anchor, best_offset, best_length);
+            for (auto i = position + 1; i < std::min(position + best_length, limit); i++) {
+                insert(data, i);
+            }
+            position += best_length;
+            anchor = position;
+        }
+    }
+
+    append_sequence(output, data + anchor, length - anchor, 0, 0);
+
+    return output;
+}
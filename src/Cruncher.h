@@ -0,0 +1,61 @@
+/*
+  Cruncher.h -- LZ4 compatible compression
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_CRUNCHER_H
+#define HAD_CRUNCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compresses data to an LZ4 block (no frame header), which has small and fast decoders for 8-bit targets.
+// Matches are found with hash chains over a 64k window. Not thread safe, use one instance per thread.
+class Cruncher {
+public:
+    Cruncher();
+
+    std::vector<uint8_t> crunch(const uint8_t *data, size_t length);
+
+private:
+    static constexpr uint32_t none = UINT32_MAX;
+
+    // Most recent position for each hash of 4 bytes.
+    std::vector<uint32_t> head;
+    // Previous position with same hash for each position.
+    std::vector<uint32_t> previous;
+
+    void insert(const uint8_t *data, size_t position);
+};
+
+#endif // HAD_CRUNCHER_H
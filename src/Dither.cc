@@ -0,0 +1,220 @@
+/*
+  Dither.cc -- reduce true color images to palette
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "Dither.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+#include "Exception.h"
+#include "utils.h"
+
+static const uint8_t bayer_matrix[8][8] = {
+    {  0, 32,  8, 40,  2, 34, 10, 42 },
+    { 48, 16, 56, 24, 50, 18, 58, 26 },
+    { 12, 44,  4, 36, 14, 46,  6, 38 },
+    { 60, 28, 52, 20, 62, 30, 54, 22 },
+    {  3, 35, 11, 43,  1, 33,  9, 41 },
+    { 51, 19, 59, 27, 49, 17, 57, 25 },
+    { 15, 47,  7, 39, 13, 45,  5, 37 },
+    { 63, 31, 55, 23, 61, 29, 53, 21 }
+};
+
+// Amplitude of ordered dither offsets, roughly the distance between neighboring colors of 8-bit palettes.
+static constexpr int ordered_spread = 48;
+
+
+Dither::Method Dither::method(const std::string& name) {
+    if (name == "none") {
+        return NONE;
+    }
+    else if (name == "ordered" || name == "bayer") {
+        return ORDERED;
+    }
+    else if (name == "floyd-steinberg") {
+        return FLOYD_STEINBERG;
+    }
+    else if (name == "atkinson") {
+        return ATKINSON;
+    }
+    else {
+        throw Exception("unknown dither method '%s'", name.c_str());
+    }
+}
+
+
+void Dither::dither(Method method, const Palette& palette, const uint8_t *rgba, size_t width, size_t height, uint8_t *indices) {
+    switch (method) {
+        case NONE:
+            for (size_t i = 0; i < width * height; i++) {
+                indices[i] = rgba[i * 4 + 3] == 0 ? palette.transparent_index : palette.lookup_nearest((rgba[i * 4] << 16) | (rgba[i * 4 + 1] << 8) | rgba[i * 4 + 2]);
+            }
+            break;
+
+        case ORDERED:
+            ordered(palette, rgba, width, height, indices);
+            break;
+
+        case FLOYD_STEINBERG:
+        case ATKINSON:
+            error_diffusion(method, palette, rgba, width, height, indices);
+            break;
+    }
+}
+
+
+void Dither::ordered(const Palette& palette, const uint8_t *rgba, size_t width, size_t height, uint8_t *indices) {
+    auto cube = palette.get_nearest_cube();
+
+    parallel_for(height, [&](size_t begin, size_t end) {
+        int16_t offsets[8];
+        auto keys = std::pmr::vector<uint16_t>(width);
+
+        for (size_t y = begin; y < end; y++) {
+            for (size_t i = 0; i < 8; i++) {
+                offsets[i] = static_cast<int16_t>((bayer_matrix[y % 8][i] * 2 - 63) * ordered_spread / 128);
+            }
+
+            auto row = rgba + y * width * 4;
+            // Independent per pixel arithmetic, so the compiler can vectorize this loop.
+            for (size_t x = 0; x < width; x++) {
+                auto offset = offsets[x % 8];
+                auto r = static_cast<uint32_t>(std::clamp(row[x * 4] + offset, 0, 255));
+                auto g = static_cast<uint32_t>(std::clamp(row[x * 4 + 1] + offset, 0, 255));
+                auto b = static_cast<uint32_t>(std::clamp(row[x * 4 + 2] + offset, 0, 255));
+                keys[x] = static_cast<uint16_t>(Palette::cube_index(r, g, b));
+            }
+
+            auto row_indices = indices + y * width;
+            for (size_t x = 0; x < width; x++) {
+                row_indices[x] = row[x * 4 + 3] == 0 ? palette.transparent_index : cube[keys[x]];
+            }
+        }
+    });
+}
+
+
+// Rows are processed in parallel as a wavefront: a row may only advance to a pixel once the row above is far enough ahead that all error it propagates there has been added.
+void Dither::error_diffusion(Method method, const Palette& palette, const uint8_t *rgba, size_t width, size_t height, uint8_t *indices) {
+    // Distance to row above, large enough that no two rows add error to the same pixel at the same time.
+    constexpr size_t lag = 4;
+
+    auto cube = palette.get_nearest_cube();
+    auto error = std::pmr::vector<float>(width * height * 3, 0.0f);
+    auto progress = std::vector<std::atomic<size_t>>(height);
+    for (auto& done : progress) {
+        done.store(0, std::memory_order_relaxed);
+    }
+
+    auto add_error = [&](size_t x, size_t y, const float *amount, float weight) {
+        if (x < width && y < height) {
+            auto target = error.data() + (y * width + x) * 3;
+            for (size_t channel = 0; channel < 3; channel++) {
+                target[channel] += amount[channel] * weight;
+            }
+        }
+    };
+
+    auto process_row = [&](size_t y) {
+        auto row = rgba + y * width * 4;
+
+        for (size_t x = 0; x < width; x++) {
+            if (y > 0) {
+                auto needed = std::min(x + lag, width);
+                while (progress[y - 1].load(std::memory_order_acquire) < needed) {
+                    std::this_thread::yield();
+                }
+            }
+
+            if (row[x * 4 + 3] == 0) {
+                indices[y * width + x] = palette.transparent_index;
+            }
+            else {
+                auto pixel_error = error.data() + (y * width + x) * 3;
+                float value[3];
+                uint32_t clamped[3];
+                for (size_t channel = 0; channel < 3; channel++) {
+                    value[channel] = row[x * 4 + channel] + pixel_error[channel];
+                    clamped[channel] = static_cast<uint32_t>(std::clamp(value[channel] + 0.5f, 0.0f, 255.0f));
+                }
+
+                auto index = cube[Palette::cube_index(clamped[0], clamped[1], clamped[2])];
+                indices[y * width + x] = index;
+
+                auto color = palette.get(index);
+                float difference[3] = {
+                    value[0] - static_cast<float>(color >> 16),
+                    value[1] - static_cast<float>((color >> 8) & 0xff),
+                    value[2] - static_cast<float>(color & 0xff)
+                };
+
+                if (method == FLOYD_STEINBERG) {
+                    add_error(x + 1, y, difference, 7.0f / 16);
+                    add_error(x - 1, y + 1, difference, 3.0f / 16);
+                    add_error(x, y + 1, difference, 5.0f / 16);
+                    add_error(x + 1, y + 1, difference, 1.0f / 16);
+                }
+                else {
+                    add_error(x + 1, y, difference, 1.0f / 8);
+                    add_error(x + 2, y, difference, 1.0f / 8);
+                    add_error(x - 1, y + 1, difference, 1.0f / 8);
+                    add_error(x, y + 1, difference, 1.0f / 8);
+                    add_error(x + 1, y + 1, difference, 1.0f / 8);
+                    add_error(x, y + 2, difference, 1.0f / 8);
+                }
+            }
+
+            progress[y].store(x + 1, std::memory_order_release);
+        }
+    };
+
+    auto threads = std::min(parallel_threads(), height);
+    auto workers = std::vector<std::thread>();
+    for (size_t i = 1; i < threads; i++) {
+        workers.emplace_back([&, i] {
+            for (size_t y = i; y < height; y += threads) {
+                process_row(y);
+            }
+        });
+    }
+    for (size_t y = 0; y < height; y += threads) {
+        process_row(y);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
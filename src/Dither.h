@@ -0,0 +1,62 @@
+/*
+  Dither.h -- reduce true color images to palette
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_DITHER_H
+#define HAD_DITHER_H
+
+#include <cstdint>
+#include <string>
+
+#include "Palette.h"
+
+class Dither {
+public:
+    enum Method {
+        NONE,
+        ORDERED,
+        FLOYD_STEINBERG,
+        ATKINSON
+    };
+
+    static Method method(const std::string& name);
+
+    // Convert RGBA pixels to palette indices. Pixels must be either opaque or fully transparent.
+    static void dither(Method method, const Palette& palette, const uint8_t *rgba, size_t width, size_t height, uint8_t *indices);
+
+private:
+    static void ordered(const Palette& palette, const uint8_t *rgba, size_t width, size_t height, uint8_t *indices);
+    static void error_diffusion(Method method, const Palette& palette, const uint8_t *rgba, size_t width, size_t height, uint8_t *indices);
+};
+
+#endif // HAD_DITHER_H
@@ -47,7 +47,7 @@ Exception::Exception(const char *format, ...) {
 Exception Exception::append(const char *format, ...) {
     va_list ap;
     va_start(ap, format);
-    message += " " + string_format(format, ap);
+    message += " " + string_format_v(format, ap);
     va_end(ap);
     update_full_message();
 
@@ -67,8 +67,9 @@ void Exception::update_full_message() {
     if (!position_set) {
         full_message = message;
     }
-    
-    full_message = string_format("%s at (%zu, %zu)", message.c_str(), x, y);
+    else {
+        full_message = string_format("%s at (%zu, %zu)", message.c_str(), x, y);
+    }
 }
 
 Exception Exception::set_position(size_t x_, size_t y_) {
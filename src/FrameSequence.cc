@@ -0,0 +1,170 @@
+/*
+  FrameSequence.cc -- delta encoded sequence of text screens
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "FrameSequence.h"
+
+#include <algorithm>
+
+#include "Exception.h"
+#include "utils.h"
+
+FrameSequence::FrameSequence(const CharsetOptions& charset_options, size_t keyframe_interval) : charset(charset_options.reduce ? Charset::unlimited : charset_options.max_characters), charset_options(charset_options), keyframe_interval(keyframe_interval) {
+    if (charset_options.transforms != 0) {
+        throw Exception("transforms not supported for frame sequences");
+    }
+}
+
+
+void FrameSequence::add_frame(const ImageView& image, uint8_t background_color) {
+    if (image.get_width() % 8 != 0 || image.get_height() % 8 != 0) {
+        throw Exception("image dimensions not multiple of 8");
+    }
+    if (frame_count == 0) {
+        width = image.get_width() / 8;
+        height = image.get_height() / 8;
+        if (width * height > 65536) {
+            throw Exception("screen too large for frame sequence");
+        }
+    }
+    else if (image.get_width() / 8 != width || image.get_height() / 8 != height) {
+        throw Exception("frame dimensions differ from first frame");
+    }
+
+    auto bg_color = std::make_optional(background_color);
+    for (size_t screen_y = 0; screen_y < height; screen_y++) {
+        for (size_t screen_x = 0; screen_x < width; screen_x++) {
+            std::optional<uint8_t> foreground_color;
+            uint8_t tile[8];
+
+            auto status = image.encode_tile(screen_x * 8, screen_y * 8, 8, 8, bg_color, foreground_color, tile);
+            if (!status.ok()) {
+                throw status.exception();
+            }
+
+            indices.push_back(charset.add(tile));
+            colors.push_back(foreground_color.value_or(0));
+        }
+    }
+
+    frame_count += 1;
+}
+
+
+static void append_index(std::vector<uint8_t>& data, uint16_t index, bool wide) {
+    data.push_back(index & 0xff);
+    if (wide) {
+        data.push_back(index >> 8);
+    }
+}
+
+
+void FrameSequence::save(const std::string& file_name_prefix) {
+    auto mapping = charset.finish(charset_options);
+    auto wide = charset_options.max_characters > 256;
+    auto cells = width * height;
+
+    auto screens = std::vector<uint16_t>(indices.size());
+    for (size_t i = 0; i < indices.size(); i++) {
+        screens[i] = mapping[indices[i]];
+    }
+
+    auto data = std::vector<uint8_t>();
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        auto screen = screens.data() + frame * cells;
+        auto frame_colors = colors.data() + frame * cells;
+
+        if (frame == 0 || (keyframe_interval > 0 && frame % keyframe_interval == 0)) {
+            data.push_back(0);
+            for (size_t i = 0; i < cells; i++) {
+                append_index(data, screen[i], wide);
+            }
+            data.insert(data.end(), frame_colors, frame_colors + cells);
+        }
+        else {
+            data.push_back(1);
+            encode_delta(screen - cells, frame_colors - cells, screen, frame_colors, data);
+        }
+    }
+
+    charset.save(file_name_prefix + "-charset.bin");
+    save_file(file_name_prefix + "-frames.bin", data);
+}
+
+
+void FrameSequence::encode_delta(const uint16_t *previous_screen, const uint8_t *previous_colors, const uint16_t *screen, const uint8_t *frame_colors, std::vector<uint8_t>& data) const {
+    auto cells = width * height;
+    auto wide = charset_options.max_characters > 256;
+    // Bytes needed to copy an unchanged cell, compared to 3 bytes for starting a new run.
+    size_t cell_size = wide ? 3 : 2;
+
+    // Unchanged stretches are skipped with std::mismatch; positions of next differences are cached since queries only move forward.
+    size_t next_screen_change = 0;
+    size_t next_color_change = 0;
+    auto next_change = [&](size_t position) {
+        if (next_screen_change < position) {
+            next_screen_change = std::mismatch(previous_screen + position, previous_screen + cells, screen + position).first - previous_screen;
+        }
+        if (next_color_change < position) {
+            next_color_change = std::mismatch(previous_colors + position, previous_colors + cells, frame_colors + position).first - previous_colors;
+        }
+        return std::min(next_screen_change, next_color_change);
+    };
+    next_screen_change = std::mismatch(previous_screen, previous_screen + cells, screen).first - previous_screen;
+    next_color_change = std::mismatch(previous_colors, previous_colors + cells, frame_colors).first - previous_colors;
+
+    auto start = next_change(0);
+    while (start < cells) {
+        auto end = start + 1;
+        while (end < cells && end - start < 255) {
+            auto next = next_change(end);
+            if (next >= cells || next + 1 - start > 255 || (next - end) * cell_size > 3) {
+                break;
+            }
+            // Include short unchanged gaps, which is cheaper than starting a new run.
+            end = next + 1;
+        }
+
+        data.push_back(end - start);
+        data.push_back(start & 0xff);
+        data.push_back(start >> 8);
+        for (auto i = start; i < end; i++) {
+            append_index(data, screen[i], wide);
+        }
+        data.insert(data.end(), frame_colors + start, frame_colors + end);
+
+        start = next_change(end);
+    }
+
+    data.push_back(0);
+}
@@ -0,0 +1,79 @@
+/*
+  FrameSequence.h -- delta encoded sequence of text screens
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_FRAME_SEQUENCE_H
+#define HAD_FRAME_SEQUENCE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Charset.h"
+#include "ImageView.h"
+
+// Sequence of text screens sharing one charset, saved as keyframes and deltas to the previous frame.
+//
+// Each frame in the frames file starts with a type byte:
+//   0: keyframe, followed by all character indices and all colors.
+//   1: delta, followed by runs of changed cells: count (1-255), offset of first cell (16 bit little endian),
+//      count character indices, count colors. A count of 0 ends the frame.
+// Character indices are 16 bit little endian if more than 256 characters are available.
+class FrameSequence {
+public:
+    Charset charset;
+
+    // If keyframe_interval is 0, only the first frame is a keyframe.
+    FrameSequence(const CharsetOptions& charset_options, size_t keyframe_interval);
+
+    [[nodiscard]] size_t get_frame_count() const { return frame_count; }
+
+    void add_frame(const ImageView& image, uint8_t background_color);
+
+    // Writes charset and frames.
+    void save(const std::string& file_name_prefix);
+
+private:
+    CharsetOptions charset_options;
+    size_t keyframe_interval;
+    size_t width = 0;
+    size_t height = 0;
+    size_t frame_count = 0;
+    // Character indices and colors of all frames.
+    std::vector<size_t> indices;
+    std::vector<uint8_t> colors;
+
+    void encode_delta(const uint16_t *previous_screen, const uint8_t *previous_colors, const uint16_t *screen, const uint8_t *frame_colors, std::vector<uint8_t>& data) const;
+};
+
+#endif // HAD_FRAME_SEQUENCE_H
@@ -0,0 +1,123 @@
+/*
+  Histogram.cc -- color histogram of image and its cells
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "Histogram.h"
+
+#include <algorithm>
+
+#include "Exception.h"
+#include "utils.h"
+
+Histogram::Histogram(const ImageView& image, size_t cell_width, size_t cell_height) : cell_width(cell_width), cell_height(cell_height), columns(image.get_width() / cell_width), rows(image.get_height() / cell_height) {
+    if (image.get_width() % cell_width != 0 || image.get_height() % cell_height != 0) {
+        throw Exception("image dimensions not multiple of cell size");
+    }
+    if (cell_width * cell_height > UINT16_MAX) {
+        throw Exception("cell size too large");
+    }
+
+    const auto& palette = *image.get_image()->get_palette();
+    transparent_index = palette.transparent_index;
+    bins = palette.size() + 1;
+    global.resize(bins);
+    cells.resize(columns * rows * bins);
+
+    parallel_for(rows, [&](size_t begin, size_t end) {
+        auto row = std::vector<uint8_t>(image.get_width());
+
+        for (size_t cell_y = begin; cell_y < end; cell_y++) {
+            auto row_cells = cells.data() + cell_y * columns * bins;
+            for (size_t y = 0; y < cell_height; y++) {
+                image.get_row(cell_y * cell_height + y, row.data());
+                for (size_t cell_x = 0; cell_x < columns; cell_x++) {
+                    auto counts = row_cells + cell_x * bins;
+                    auto pixels = row.data() + cell_x * cell_width;
+                    for (size_t x = 0; x < cell_width; x++) {
+                        counts[bin(pixels[x])] += 1;
+                    }
+                }
+            }
+        }
+    });
+
+    for (size_t cell = 0; cell < columns * rows; cell++) {
+        for (size_t i = 0; i < bins; i++) {
+            global[i] += cells[cell * bins + i];
+        }
+    }
+}
+
+
+size_t Histogram::clashes(uint8_t background_color, size_t colors_per_cell) const {
+    size_t count = 0;
+
+    for (size_t cell = 0; cell < columns * rows; cell++) {
+        auto counts = cells.data() + cell * bins;
+        size_t colors = 0;
+        for (size_t i = 0; i < bins - 1; i++) {
+            if (counts[i] > 0 && i != background_color) {
+                colors += 1;
+            }
+        }
+        if (colors > colors_per_cell) {
+            count += 1;
+        }
+    }
+
+    return count;
+}
+
+
+std::vector<uint8_t> Histogram::best_backgrounds(size_t colors_per_cell) const {
+    auto candidates = std::vector<uint8_t>();
+    size_t fewest_clashes = SIZE_MAX;
+
+    for (size_t color = 0; color < bins - 1; color++) {
+        if (global[color] == 0) {
+            continue;
+        }
+        auto color_clashes = clashes(static_cast<uint8_t>(color), colors_per_cell);
+        if (color_clashes < fewest_clashes) {
+            fewest_clashes = color_clashes;
+            candidates.clear();
+        }
+        if (color_clashes == fewest_clashes) {
+            candidates.push_back(static_cast<uint8_t>(color));
+        }
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(), [this](uint8_t a, uint8_t b) { return global[a] > global[b]; });
+
+    return candidates;
+}
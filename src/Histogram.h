@@ -0,0 +1,78 @@
+/*
+  Histogram.h -- color histogram of image and its cells
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_HISTOGRAM_H
+#define HAD_HISTOGRAM_H
+
+#include <cstdint>
+#include <vector>
+
+#include "ImageView.h"
+
+class Histogram {
+public:
+    Histogram(const ImageView& image, size_t cell_width, size_t cell_height);
+
+    [[nodiscard]] size_t get_columns() const { return columns; }
+    [[nodiscard]] size_t get_rows() const { return rows; }
+    [[nodiscard]] size_t get_cell_width() const { return cell_width; }
+    [[nodiscard]] size_t get_cell_height() const { return cell_height; }
+    [[nodiscard]] size_t get_palette_size() const { return bins - 1; }
+
+    // Number of pixels of color in whole image.
+    [[nodiscard]] size_t get(uint8_t color) const { return global[bin(color)]; }
+    // Number of pixels of color in cell.
+    [[nodiscard]] size_t get(size_t cell_x, size_t cell_y, uint8_t color) const { return cells[(cell_y * columns + cell_x) * bins + bin(color)]; }
+
+    // Number of cells that need more than colors_per_cell colors in addition to background color.
+    [[nodiscard]] size_t clashes(uint8_t background_color, size_t colors_per_cell = 1) const;
+    // Colors that cause the fewest clashes as background, most used first.
+    [[nodiscard]] std::vector<uint8_t> best_backgrounds(size_t colors_per_cell = 1) const;
+
+private:
+    // Transparent pixels are counted in last bin.
+    [[nodiscard]] size_t bin(uint8_t color) const { return color == transparent_index ? bins - 1 : color; }
+
+    size_t cell_width;
+    size_t cell_height;
+    size_t columns;
+    size_t rows;
+    size_t bins;
+    uint8_t transparent_index;
+
+    std::vector<size_t> global;
+    std::vector<uint16_t> cells;
+};
+
+#endif // HAD_HISTOGRAM_H
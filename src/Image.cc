@@ -34,9 +34,10 @@
 
 #include "Image.h"
 
+#include "CellIndex.h"
 #include "Exception.h"
 
-Image::Image(size_t width, size_t height, std::shared_ptr<Palette> palette_) : pixels(width, height), palette(palette_) { }
+Image::Image(size_t width, size_t height, std::shared_ptr<const Palette> palette_, size_t tile_width, size_t tile_height, size_t bits_per_pixel) : pixels(width, height, tile_width, tile_height, bits_per_pixel), palette(palette_) { }
 
 uint32_t Image::get_rgb(size_t x, size_t y) {
     return palette->get(pixels.get(x, y));
@@ -44,16 +45,183 @@ uint32_t Image::get_rgb(size_t x, size_t y) {
 
 void Image::set_rgb(size_t x, size_t y, uint32_t color) {
     pixels.set(x, y, palette->lookup(color));
+    changed();
 }
 
 uint8_t Image::get_byte(size_t x, size_t y, std::optional<uint8_t>& background_color, std::optional<uint8_t>& foreground_color) {
     if (x % 8 != 0) {
         throw Exception("x not multiple of 8");
     }
-    
-    uint8_t byte = 0;
+
+    uint8_t row[8];
+    for (size_t bit = 0; bit < 8; bit++) {
+        row[bit] = get(x + bit, y);
+    }
+
+    uint8_t byte;
+    auto status = encode_byte(row, x, y, background_color, foreground_color, byte);
+    if (!status.ok()) {
+        throw status.exception();
+    }
+    return byte;
+}
+
+void Image::get_tile(size_t x, size_t y, size_t width, size_t height, std::optional<uint8_t>& background_color, std::optional<uint8_t>& foreground_color, uint8_t *bytes) {
+    auto status = encode_tile(x, y, width, height, background_color, foreground_color, bytes);
+    if (!status.ok()) {
+        throw status.exception();
+    }
+}
+
+Status Image::encode_tile(size_t x, size_t y, size_t width, size_t height, std::optional<uint8_t>& background_color, std::optional<uint8_t>& foreground_color, uint8_t *bytes) {
+    if (width % 8 != 0) {
+        throw Exception("tile width not multiple of 8");
+    }
+
+    // Empty and single color cells encode to uniform bytes.
+    if (x % width == 0 && y % height == 0 && x + width <= get_width() && y + height <= get_height()) {
+        auto cell_index = get_cell_index(width, height);
+        if (cell_index) {
+            const auto& cell = cell_index->get(x / width, y / height);
+            if (cell.is_empty()) {
+                std::fill(bytes, bytes + width / 8 * height, 0);
+                return {};
+            }
+            else if (cell.is_single_color() && !cell.has_transparency) {
+                auto color = cell.dominant[0];
+                uint8_t byte;
+                if (color == background_color) {
+                    byte = 0;
+                }
+                else if (color == foreground_color) {
+                    byte = 0xff;
+                }
+                else if (!background_color) {
+                    background_color = color;
+                    byte = 0;
+                }
+                else if (!foreground_color) {
+                    foreground_color = color;
+                    byte = 0xff;
+                }
+                else {
+                    return {Status::COLOR_CLASH, x, y};
+                }
+                std::fill(bytes, bytes + width / 8 * height, byte);
+                return {};
+            }
+        }
+    }
+
+    if (pixels.has_tile_size(width, height) && x % width == 0 && y % height == 0 && pixels.check_bounds(x + width - 1, y + height - 1)) {
+        // Tiles are encoded concurrently, so each call needs its own buffer.
+        uint8_t buffer[max_buffered_tile_size];
+        auto large_buffer = std::vector<uint8_t>();
+        auto tile = buffer;
+        if (width * height > sizeof(buffer)) {
+            large_buffer.resize(width * height);
+            tile = large_buffer.data();
+        }
+        pixels.get_tile(x / width, y / height, tile);
+        for (size_t tile_y = 0; tile_y < height; tile_y++) {
+            for (size_t byte_x = 0; byte_x < width / 8; byte_x++) {
+                auto status = encode_byte(tile + tile_y * width + byte_x * 8, x + byte_x * 8, y + tile_y, background_color, foreground_color, *(bytes++));
+                if (!status.ok()) {
+                    return status;
+                }
+            }
+        }
+    }
+    else {
+        uint8_t row[8];
+        for (size_t tile_y = 0; tile_y < height; tile_y++) {
+            for (size_t byte_x = 0; byte_x < width / 8; byte_x++) {
+                for (size_t bit = 0; bit < 8; bit++) {
+                    row[bit] = get(x + byte_x * 8 + bit, y + tile_y);
+                }
+                auto status = encode_byte(row, x + byte_x * 8, y + tile_y, background_color, foreground_color, *(bytes++));
+                if (!status.ok()) {
+                    return status;
+                }
+            }
+        }
+    }
+
+    return {};
+}
+
+Status Image::encode_multicolor_tile(size_t x, size_t y, size_t width, size_t height, uint8_t background_color, std::optional<uint8_t> colors[3], uint8_t *bytes) {
+    if (width % 4 != 0) {
+        throw Exception("tile width not multiple of 4");
+    }
+
+    auto tiled = pixels.has_tile_size(width, height) && x % width == 0 && y % height == 0 && pixels.check_bounds(x + width - 1, y + height - 1);
+    uint8_t buffer[max_buffered_tile_size];
+    auto large_buffer = std::vector<uint8_t>();
+    auto tile = buffer;
+    if (tiled) {
+        if (width * height > sizeof(buffer)) {
+            large_buffer.resize(width * height);
+            tile = large_buffer.data();
+        }
+        pixels.get_tile(x / width, y / height, tile);
+    }
+
+    for (size_t tile_y = 0; tile_y < height; tile_y++) {
+        for (size_t byte_x = 0; byte_x < width / 4; byte_x++) {
+            uint8_t byte = 0;
+            for (size_t pixel_x = byte_x * 4; pixel_x < byte_x * 4 + 4; pixel_x++) {
+                auto pixel = tiled ? tile[tile_y * width + pixel_x] : get(x + pixel_x, y + tile_y);
+                uint8_t code = 0;
+                if (pixel != palette->transparent_index && pixel != background_color) {
+                    for (code = 1; code <= 3; code++) {
+                        if (!colors[code - 1].has_value()) {
+                            colors[code - 1] = pixel;
+                        }
+                        if (colors[code - 1] == pixel) {
+                            break;
+                        }
+                    }
+                    if (code > 3) {
+                        return {Status::COLOR_CLASH, x + pixel_x, y + tile_y};
+                    }
+                }
+                byte = static_cast<uint8_t>((byte << 2) | code);
+            }
+            *(bytes++) = byte;
+        }
+    }
+
+    return {};
+}
+
+
+std::shared_ptr<const CellIndex> Image::get_cell_index(size_t cell_width, size_t cell_height) {
+    if (!CellIndex::supports(*palette) || cell_width * cell_height > UINT16_MAX) {
+        return {};
+    }
+
+    auto lock = std::lock_guard<std::mutex>(cell_index_mutex);
+    auto current_generation = generation.load(std::memory_order_relaxed);
+    if (cell_indices_generation != current_generation) {
+        cell_indices.clear();
+        cell_indices_generation = current_generation;
+    }
+    for (const auto& cell_index : cell_indices) {
+        if (cell_index->get_cell_width() == cell_width && cell_index->get_cell_height() == cell_height) {
+            return cell_index;
+        }
+    }
+    auto cell_index = std::make_shared<const CellIndex>(*this, cell_width, cell_height);
+    cell_indices.push_back(cell_index);
+    return cell_index;
+}
+
+
+Status Image::encode_byte(const uint8_t *row, size_t x, size_t y, std::optional<uint8_t>& background_color, std::optional<uint8_t>& foreground_color, uint8_t& byte) const {
+    byte = 0;
     for (size_t bit = 0; bit < 8; bit++) {
-        auto pixel = get(x + bit, y);
+        auto pixel = row[bit];
         
         byte <<= 1;
         if (pixel == palette->transparent_index || (background_color.has_value() && pixel == background_color)) {
@@ -70,10 +238,10 @@ uint8_t Image::get_byte(size_t x, size_t y, std::optional<uint8_t>& background_c
                 byte |= 1;
             }
             else  {
-                throw Exception("color clash").set_position(x + bit, y);
+                return {Status::COLOR_CLASH, x + bit, y};
             }
         }
     }
     
-    return byte;
+    return {};
 }
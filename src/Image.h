@@ -35,29 +35,65 @@
 #ifndef HAD_IMAGE_H
 #define HAD_IMAGE_H
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <vector>
 
 #include "Matrix.h"
 #include "Palette.h"
+#include "Status.h"
+
+class CellIndex;
 
 class Image {
 public:
-    Image(size_t width, size_t height, std::shared_ptr<Palette> palette);
+    Image(size_t width, size_t height, std::shared_ptr<const Palette> palette, size_t tile_width = 0, size_t tile_height = 0, size_t bits_per_pixel = 8);
 
     size_t get_width() const { return pixels.get_width(); }
     size_t get_height() const { return pixels.get_height(); }
+    const std::shared_ptr<const Palette>& get_palette() const { return palette; }
 
     uint8_t get(size_t x, size_t y) { return pixels.get(x, y); }
-    void set(size_t x, size_t y, uint8_t index) { pixels.set(x, y, index); }
+    void set(size_t x, size_t y, uint8_t index) { pixels.set(x, y, index); changed(); }
+    void get_row(size_t y, uint8_t *indices) const { pixels.get_row(y, indices); }
+    void set_row(size_t y, const uint8_t *indices) { pixels.set_row(y, indices); changed(); }
     
     uint32_t get_rgb(size_t x, size_t y);
     void set_rgb(size_t x, size_t y, uint32_t color);
     
     uint8_t get_byte(size_t x, size_t y, std::optional<uint8_t>& background_color, std::optional<uint8_t>& foreground_color);
+    void get_tile(size_t x, size_t y, size_t width, size_t height, std::optional<uint8_t>& background_color, std::optional<uint8_t>& foreground_color, uint8_t *bytes);
+    // Like get_tile(), but reports color clashes in returned status instead of throwing.
+    Status encode_tile(size_t x, size_t y, size_t width, size_t height, std::optional<uint8_t>& background_color, std::optional<uint8_t>& foreground_color, uint8_t *bytes);
+
+    // Encode tile with 2 bits per pixel for C64 multicolor modes: background_color is encoded as 0, colors[i] as i + 1.
+    // Unset colors are assigned in order of appearance.
+    Status encode_multicolor_tile(size_t x, size_t y, size_t width, size_t height, uint8_t background_color, std::optional<uint8_t> colors[3], uint8_t *bytes);
+
+    // Colors used in cells of given size, computed on first use and kept until the image is changed.
+    // Returns nullptr if palette is too large for CellIndex.
+    std::shared_ptr<const CellIndex> get_cell_index(size_t cell_width, size_t cell_height);
     
+    static size_t bits_per_pixel_for(const Palette& palette, bool transparency) { return Matrix::bits_per_pixel_for(transparency ? std::max(palette.size(), size_t{palette.transparent_index} + 1) : palette.size()); }
+
 private:
+    // Tiles up to this many pixels are copied into a buffer on the stack when encoding.
+    static constexpr size_t max_buffered_tile_size = 512;
+
+    Status encode_byte(const uint8_t *row, size_t x, size_t y, std::optional<uint8_t>& background_color, std::optional<uint8_t>& foreground_color, uint8_t& byte) const;
+    // Only needs to make generation differ from before, so a plain load and store is enough, even if pixels are set concurrently.
+    void changed() { generation.store(generation.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
     Matrix pixels;
-    std::shared_ptr<Palette> palette;
+    std::shared_ptr<const Palette> palette;
+    // Changed whenever pixels are changed, cell indices are discarded if it differs from when they were computed.
+    std::atomic<size_t> generation{0};
+    std::mutex cell_index_mutex;
+    size_t cell_indices_generation = 0;
+    std::vector<std::shared_ptr<const CellIndex>> cell_indices;
 };
 
 #endif // HAD_IMAGE_H
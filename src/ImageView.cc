@@ -0,0 +1,117 @@
+/*
+  ImageView.cc -- rectangular region of an image
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ImageView.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "Exception.h"
+
+ImageView::Region::Region(const std::string& specification) {
+    size_t end = 0;
+    if (sscanf(specification.c_str(), "%zu,%zu,%zu,%zu%zn", &x, &y, &width, &height, &end) != 4 || end != specification.length()) {
+        throw Exception("invalid region '%s', expected x,y,width,height", specification.c_str());
+    }
+    if (width == 0 || height == 0) {
+        throw Exception("empty region '%s'", specification.c_str());
+    }
+}
+
+ImageView::ImageView(std::shared_ptr<Image> image_) : image(std::move(image_)), x_offset(0), y_offset(0), width(image->get_width()), height(image->get_height()) { }
+
+ImageView::ImageView(std::shared_ptr<Image> image_, const Region& region) : image(std::move(image_)), x_offset(region.x), y_offset(region.y), width(region.width), height(region.height) {
+    if (x_offset + width > image->get_width() || y_offset + height > image->get_height()) {
+        throw Exception("region %zux%zu+%zu+%zu outside of %zux%zu image", width, height, x_offset, y_offset, image->get_width(), image->get_height());
+    }
+}
+
+uint8_t ImageView::get(size_t x, size_t y) const {
+    if (!check_bounds(x, y)) {
+        throw Exception("invalid coordinates (%zu, %zu)", x, y);
+    }
+    return image->get(x_offset + x, y_offset + y);
+}
+
+uint32_t ImageView::get_rgb(size_t x, size_t y) const {
+    if (!check_bounds(x, y)) {
+        throw Exception("invalid coordinates (%zu, %zu)", x, y);
+    }
+    return image->get_rgb(x_offset + x, y_offset + y);
+}
+
+void ImageView::get_row(size_t y, uint8_t *indices) const {
+    check_region(0, y, width, 1);
+
+    if (x_offset == 0 && width == image->get_width()) {
+        image->get_row(y_offset + y, indices);
+    }
+    else {
+        auto row = std::pmr::vector<uint8_t>(image->get_width());
+        image->get_row(y_offset + y, row.data());
+        std::copy(row.begin() + x_offset, row.begin() + x_offset + width, indices);
+    }
+}
+
+uint8_t ImageView::get_byte(size_t x, size_t y, std::optional<uint8_t>& background_color, std::optional<uint8_t>& foreground_color) const {
+    if (x % 8 != 0) {
+        throw Exception("x not multiple of 8");
+    }
+
+    uint8_t byte;
+    get_tile(x, y, 8, 1, background_color, foreground_color, &byte);
+    return byte;
+}
+
+void ImageView::get_tile(size_t x, size_t y, size_t tile_width, size_t tile_height, std::optional<uint8_t>& background_color, std::optional<uint8_t>& foreground_color, uint8_t *bytes) const {
+    check_region(x, y, tile_width, tile_height);
+    image->get_tile(x_offset + x, y_offset + y, tile_width, tile_height, background_color, foreground_color, bytes);
+}
+
+Status ImageView::encode_tile(size_t x, size_t y, size_t tile_width, size_t tile_height, std::optional<uint8_t>& background_color, std::optional<uint8_t>& foreground_color, uint8_t *bytes) const {
+    check_region(x, y, tile_width, tile_height);
+    return image->encode_tile(x_offset + x, y_offset + y, tile_width, tile_height, background_color, foreground_color, bytes);
+}
+
+Status ImageView::encode_multicolor_tile(size_t x, size_t y, size_t tile_width, size_t tile_height, uint8_t background_color, std::optional<uint8_t> colors[3], uint8_t *bytes) const {
+    check_region(x, y, tile_width, tile_height);
+    return image->encode_multicolor_tile(x_offset + x, y_offset + y, tile_width, tile_height, background_color, colors, bytes);
+}
+
+void ImageView::check_region(size_t x, size_t y, size_t region_width, size_t region_height) const {
+    if (x + region_width > width || y + region_height > height) {
+        throw Exception("invalid coordinates (%zu, %zu)", x + region_width - 1, y + region_height - 1);
+    }
+}
@@ -0,0 +1,87 @@
+/*
+  ImageView.h -- rectangular region of an image
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_IMAGE_VIEW_H
+#define HAD_IMAGE_VIEW_H
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "Image.h"
+
+class ImageView {
+public:
+    class Region {
+    public:
+        Region(size_t x_, size_t y_, size_t width_, size_t height_) : x(x_), y(y_), width(width_), height(height_) { }
+        explicit Region(const std::string& specification);
+
+        size_t x;
+        size_t y;
+        size_t width;
+        size_t height;
+    };
+
+    ImageView(std::shared_ptr<Image> image); // NOLINT(google-explicit-constructor)
+    ImageView(std::shared_ptr<Image> image, const Region& region);
+
+    [[nodiscard]] size_t get_width() const { return width; }
+    [[nodiscard]] size_t get_height() const { return height; }
+    [[nodiscard]] size_t get_x_offset() const { return x_offset; }
+    [[nodiscard]] size_t get_y_offset() const { return y_offset; }
+    [[nodiscard]] const std::shared_ptr<Image>& get_image() const { return image; }
+
+    [[nodiscard]] bool check_bounds(size_t x, size_t y) const { return x < width && y < height; }
+
+    uint8_t get(size_t x, size_t y) const;
+    uint32_t get_rgb(size_t x, size_t y) const;
+
+    void get_row(size_t y, uint8_t *indices) const;
+    uint8_t get_byte(size_t x, size_t y, std::optional<uint8_t>& background_color, std::optional<uint8_t>& foreground_color) const;
+    void get_tile(size_t x, size_t y, size_t tile_width, size_t tile_height, std::optional<uint8_t>& background_color, std::optional<uint8_t>& foreground_color, uint8_t *bytes) const;
+    Status encode_tile(size_t x, size_t y, size_t tile_width, size_t tile_height, std::optional<uint8_t>& background_color, std::optional<uint8_t>& foreground_color, uint8_t *bytes) const;
+    Status encode_multicolor_tile(size_t x, size_t y, size_t tile_width, size_t tile_height, uint8_t background_color, std::optional<uint8_t> colors[3], uint8_t *bytes) const;
+
+private:
+    void check_region(size_t x, size_t y, size_t region_width, size_t region_height) const;
+
+    std::shared_ptr<Image> image;
+    size_t x_offset;
+    size_t y_offset;
+    size_t width;
+    size_t height;
+};
+
+#endif // HAD_IMAGE_VIEW_H
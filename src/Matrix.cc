@@ -34,27 +34,253 @@
 
 #include "Matrix.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "Exception.h"
 #include "utils.h"
 
-Matrix::Matrix(size_t w, size_t h) : width(w), height(h), data(std::make_unique<unsigned char[]>(width * height)) { }
+static void unpack_bytes(const uint8_t *bytes, size_t count, size_t bits_per_pixel, uint8_t *values) {
+    switch (bits_per_pixel) {
+        case 1:
+            for (size_t i = 0; i < count; i++) {
+                for (size_t bit = 0; bit < 8; bit++) {
+                    values[i * 8 + bit] = (bytes[i] >> bit) & 0x1;
+                }
+            }
+            break;
+
+        case 2:
+            for (size_t i = 0; i < count; i++) {
+                for (size_t part = 0; part < 4; part++) {
+                    values[i * 4 + part] = (bytes[i] >> (part * 2)) & 0x3;
+                }
+            }
+            break;
+
+        case 4:
+            for (size_t i = 0; i < count; i++) {
+                values[i * 2] = bytes[i] & 0xf;
+                values[i * 2 + 1] = bytes[i] >> 4;
+            }
+            break;
+
+        default:
+            memcpy(values, bytes, count);
+            break;
+    }
+}
+
+static void pack_bytes(const uint8_t *values, size_t count, size_t bits_per_pixel, uint8_t *bytes) {
+    switch (bits_per_pixel) {
+        case 1:
+            for (size_t i = 0; i < count; i++) {
+                uint8_t byte = 0;
+                for (size_t bit = 0; bit < 8; bit++) {
+                    byte |= values[i * 8 + bit] << bit;
+                }
+                bytes[i] = byte;
+            }
+            break;
+
+        case 2:
+            for (size_t i = 0; i < count; i++) {
+                uint8_t byte = 0;
+                for (size_t part = 0; part < 4; part++) {
+                    byte |= values[i * 4 + part] << (part * 2);
+                }
+                bytes[i] = byte;
+            }
+            break;
+
+        case 4:
+            for (size_t i = 0; i < count; i++) {
+                bytes[i] = values[i * 2] | (values[i * 2 + 1] << 4);
+            }
+            break;
+
+        default:
+            memcpy(bytes, values, count);
+            break;
+    }
+}
+
+static size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+Matrix::Matrix(size_t w, size_t h, size_t tw, size_t th, size_t bpp) : width(w), height(h), tile_width(tw), tile_height(th), bits_per_pixel(bpp) {
+    switch (bits_per_pixel) {
+        case 1:
+            pixel_shift = 3;
+            break;
+        case 2:
+            pixel_shift = 2;
+            break;
+        case 4:
+            pixel_shift = 1;
+            break;
+        case 8:
+            pixel_shift = 0;
+            break;
+        default:
+            throw Exception("unsupported bits per pixel %zu", bits_per_pixel);
+    }
+    pixel_mask = (size_t{1} << pixel_shift) - 1;
+    value_mask = static_cast<uint8_t>((1u << bits_per_pixel) - 1);
+
+    // Rows and tiles start on byte boundaries.
+    size_t pixels;
+    if (tile_width == 0 || tile_height == 0) {
+        tile_width = 0;
+        tile_height = 0;
+        tiles_per_row = 0;
+        tile_stride = 0;
+        row_stride = round_up(width, pixel_mask + 1);
+        pixels = row_stride * height;
+    }
+    else {
+        tiles_per_row = (width + tile_width - 1) / tile_width;
+        tile_stride = round_up(tile_width * tile_height, pixel_mask + 1);
+        row_stride = 0;
+        pixels = tiles_per_row * ((height + tile_height - 1) / tile_height) * tile_stride;
+    }
+    data.resize(pixels >> pixel_shift);
+}
+
+size_t Matrix::bits_per_pixel_for(size_t values) {
+    if (values <= 2) {
+        return 1;
+    }
+    else if (values <= 4) {
+        return 2;
+    }
+    else if (values <= 16) {
+        return 4;
+    }
+    else {
+        return 8;
+    }
+}
+
+void Matrix::get_tile(size_t tile_x, size_t tile_y, uint8_t *values) const {
+    if (!is_tiled()) {
+        throw Exception("matrix is not tiled");
+    }
+    if (!check_bounds(tile_x * tile_width, tile_y * tile_height)) {
+        throw Exception("invalid tile coordinates (%zu, %zu)", tile_x, tile_y);
+    }
+
+    unpack((tile_y * tiles_per_row + tile_x) * tile_stride, tile_width * tile_height, values);
+}
 
 uint8_t Matrix::get(size_t x, size_t y) const {
     if (!check_bounds(x, y)) {
         throw Exception("invalid coordinates (%zu, %zu)", x, y);
     }
 
-    return data[y * width + x];
+    return get_value(index(x, y));
 }
 
 void Matrix::set(size_t x, size_t y, uint8_t value) {
     if (!check_bounds(x, y)) {
         throw Exception("invalid coordinates (%zu, %zu)", x, y);
     }
+    if (value > value_mask) {
+        throw Exception("value %u out of range", value).set_position(x, y);
+    }
 
-    data[y * width + x] = value;
+    set_value(index(x, y), value);
+}
+
+void Matrix::get_row(size_t y, uint8_t *row) const {
+    if (!check_bounds(0, y)) {
+        throw Exception("invalid row %zu", y);
+    }
+
+    if (!is_tiled()) {
+        unpack(index(0, y), width, row);
+        return;
+    }
+
+    for (size_t x = 0; x < width; x += tile_width) {
+        unpack(index(x, y), std::min(tile_width, width - x), row + x);
+    }
+}
+
+void Matrix::set_row(size_t y, const uint8_t *row) {
+    if (!check_bounds(0, y)) {
+        throw Exception("invalid row %zu", y);
+    }
+    check_values(row, width);
+
+    if (!is_tiled()) {
+        pack(index(0, y), width, row);
+        return;
+    }
+
+    for (size_t x = 0; x < width; x += tile_width) {
+        pack(index(x, y), std::min(tile_width, width - x), row + x);
+    }
 }
 
 void Matrix::save(const std::string file_name) const {
-    save_file(file_name, data.get(), width * height);
+    if (!is_tiled() && bits_per_pixel == 8) {
+        save_file(file_name, data.data(), width * height);
+        return;
+    }
+
+    auto rows = std::pmr::vector<uint8_t>(width * height);
+    for (size_t y = 0; y < height; y++) {
+        get_row(y, rows.data() + y * width);
+    }
+    save_file(file_name, rows.data(), rows.size());
+}
+
+void Matrix::check_values(const uint8_t *values, size_t count) const {
+    uint8_t all = 0;
+    for (size_t i = 0; i < count; i++) {
+        all |= values[i];
+    }
+    if ((all & ~value_mask) == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (values[i] > value_mask) {
+            throw Exception("value %u out of range", values[i]);
+        }
+    }
+}
+
+void Matrix::unpack(size_t i, size_t count, uint8_t *values) const {
+    size_t n = 0;
+
+    while (n < count && (i + n) & pixel_mask) {
+        values[n] = get_value(i + n);
+        n++;
+    }
+    auto bytes = (count - n) >> pixel_shift;
+    unpack_bytes(data.data() + ((i + n) >> pixel_shift), bytes, bits_per_pixel, values + n);
+    n += bytes << pixel_shift;
+    while (n < count) {
+        values[n] = get_value(i + n);
+        n++;
+    }
+}
+
+void Matrix::pack(size_t i, size_t count, const uint8_t *values) {
+    size_t n = 0;
+
+    while (n < count && (i + n) & pixel_mask) {
+        set_value(i + n, values[n]);
+        n++;
+    }
+    auto bytes = (count - n) >> pixel_shift;
+    pack_bytes(values + n, bytes, bits_per_pixel, data.data() + ((i + n) >> pixel_shift));
+    n += bytes << pixel_shift;
+    while (n < count) {
+        set_value(i + n, values[n]);
+        n++;
+    }
 }
@@ -36,11 +36,15 @@
 
 #include <cstdint>
 #include <memory>
+#include <memory_resource>
 #include <string>
+#include <vector>
 
 class Matrix {
 public:
-    Matrix(size_t width, size_t height);
+    // If tile_width and tile_height are given, data is stored tile-major: all pixels of a tile are contiguous, rows within a tile are tile_width pixels apart.
+    // bits_per_pixel of 1, 2, or 4 packs several values into each byte, starting at the least significant bits.
+    Matrix(size_t width, size_t height, size_t tile_width = 0, size_t tile_height = 0, size_t bits_per_pixel = 8);
     ~Matrix() {}
     
     bool check_bounds(size_t x, size_t y) const {
@@ -49,17 +53,65 @@ public:
     
     size_t get_width() const { return width; }
     size_t get_height() const { return height; }
-    const uint8_t* get_data() const { return data.get(); }
+    size_t get_bits_per_pixel() const { return bits_per_pixel; }
+    const uint8_t* get_data() const { return data.data(); }
+
+    bool is_tiled() const { return tile_width > 0; }
+    bool has_tile_size(size_t w, size_t h) const { return tile_width == w && tile_height == h; }
+    size_t get_tile_width() const { return tile_width; }
+    size_t get_tile_height() const { return tile_height; }
+    void get_tile(size_t tile_x, size_t tile_y, uint8_t *values) const;
 
     uint8_t get(size_t x, size_t y) const;
     void set(size_t x, size_t y, uint8_t value);
+
+    void get_row(size_t y, uint8_t* row) const;
+    void set_row(size_t y, const uint8_t* row);
     
     void save(const std::string file_name) const;
 
+    static size_t bits_per_pixel_for(size_t values);
+
 private:
+    size_t index(size_t x, size_t y) const {
+        if (!is_tiled()) {
+            return y * row_stride + x;
+        }
+        return ((y / tile_height) * tiles_per_row + x / tile_width) * tile_stride + (y % tile_height) * tile_width + x % tile_width;
+    }
+
+    uint8_t get_value(size_t i) const {
+        if (bits_per_pixel == 8) {
+            return data[i];
+        }
+        return (data[i >> pixel_shift] >> ((i & pixel_mask) * bits_per_pixel)) & value_mask;
+    }
+    void set_value(size_t i, uint8_t value) {
+        if (bits_per_pixel == 8) {
+            data[i] = value;
+            return;
+        }
+        auto shift = (i & pixel_mask) * bits_per_pixel;
+        auto &byte = data[i >> pixel_shift];
+        byte = static_cast<uint8_t>((byte & ~(value_mask << shift)) | (value << shift));
+    }
+
+    void check_values(const uint8_t *values, size_t count) const;
+    void unpack(size_t i, size_t count, uint8_t *values) const;
+    void pack(size_t i, size_t count, const uint8_t *values);
+
     size_t width;
     size_t height;
-    std::unique_ptr<uint8_t[]> data;
+    size_t tile_width;
+    size_t tile_height;
+    size_t tiles_per_row;
+    size_t row_stride;
+    size_t tile_stride;
+    size_t bits_per_pixel;
+    size_t pixel_shift;
+    size_t pixel_mask;
+    uint8_t value_mask;
+    std::pmr::vector<uint8_t> data;
 };
 
 #endif // HAD_MATRIX_H
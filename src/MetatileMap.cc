@@ -0,0 +1,143 @@
+/*
+  MetatileMap.cc -- level map of metatiles
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "MetatileMap.h"
+
+#include "Exception.h"
+#include "utils.h"
+
+MetatileMap::MetatileMap(size_t metatile_size, const CharsetOptions& charset_options, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color) : charset(charset_options.reduce ? Charset::unlimited : charset_options.max_characters), metatile_size(metatile_size), charset_options(charset_options), background_color(background_color), foreground_color(foreground_color) {
+    if (metatile_size == 0) {
+        throw Exception("invalid metatile size 0");
+    }
+    if (charset_options.transforms != 0) {
+        throw Exception("transforms not supported for metatile maps");
+    }
+}
+
+
+void MetatileMap::add_band(const ImageView& band, size_t y) {
+    auto pixel_size = metatile_size * 8;
+    if (band.get_width() % pixel_size != 0 || band.get_height() != pixel_size) {
+        throw Exception("image dimensions not multiple of metatile size");
+    }
+    if (height == 0) {
+        width = band.get_width() / pixel_size;
+    }
+    else if (band.get_width() / pixel_size != width) {
+        throw Exception("band width doesn't match map width");
+    }
+
+    auto characters = std::u32string(metatile_size * metatile_size, 0);
+
+    for (size_t map_x = 0; map_x < width; map_x++) {
+        for (size_t cell_y = 0; cell_y < metatile_size; cell_y++) {
+            for (size_t cell_x = 0; cell_x < metatile_size; cell_x++) {
+                std::optional<uint8_t> bg_color = background_color;
+                std::optional<uint8_t> fg_color = foreground_color;
+                uint8_t tile[8];
+
+                auto status = band.encode_tile(map_x * pixel_size + cell_x * 8, cell_y * 8, 8, 8, bg_color, fg_color, tile);
+                if (!status.ok()) {
+                    status.y += y;
+                    throw status.exception();
+                }
+                characters[cell_y * metatile_size + cell_x] = static_cast<char32_t>(charset.add(tile));
+            }
+        }
+        map.push_back(add_metatile(characters));
+    }
+    height += 1;
+}
+
+
+size_t MetatileMap::add_metatile(const std::u32string& characters) {
+    auto it = metatile_index.find(characters);
+    if (it != metatile_index.end()) {
+        return it->second;
+    }
+
+    auto index = get_metatile_count();
+    metatiles.insert(metatiles.end(), characters.begin(), characters.end());
+    metatile_index[characters] = index;
+    return index;
+}
+
+
+// Append value as 8 bit or 16 bit little endian.
+static void append_index(std::vector<uint8_t>& data, size_t value, bool wide) {
+    data.push_back(value & 0xff);
+    if (wide) {
+        data.push_back(value >> 8);
+    }
+}
+
+
+void MetatileMap::save(const std::string& file_name_prefix) {
+    auto mapping = charset.finish(charset_options);
+
+    // Reducing the charset can make metatiles identical, so rebuild metatile table.
+    auto old_metatiles = std::move(metatiles);
+    metatiles.clear();
+    metatile_index.clear();
+    auto metatile_mapping = std::vector<size_t>(old_metatiles.size() / (metatile_size * metatile_size));
+    auto characters = std::u32string(metatile_size * metatile_size, 0);
+    for (size_t index = 0; index < metatile_mapping.size(); index++) {
+        for (size_t i = 0; i < characters.size(); i++) {
+            characters[i] = static_cast<char32_t>(mapping[old_metatiles[index * characters.size() + i]]);
+        }
+        metatile_mapping[index] = add_metatile(characters);
+    }
+    for (auto& index : map) {
+        index = metatile_mapping[index];
+    }
+
+    if (get_metatile_count() > 65536) {
+        throw Exception("too many metatiles (%zu)", get_metatile_count());
+    }
+
+    charset.save(file_name_prefix + "-charset.bin");
+
+    auto data = std::vector<uint8_t>();
+    for (auto index : metatiles) {
+        append_index(data, index, charset.get_size() > 256);
+    }
+    save_file(file_name_prefix + "-metatiles.bin", data);
+
+    data.clear();
+    for (auto index : map) {
+        append_index(data, index, get_metatile_count() > 256);
+    }
+    save_file(file_name_prefix + "-map.bin", data);
+}
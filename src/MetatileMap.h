@@ -0,0 +1,83 @@
+/*
+  MetatileMap.h -- level map of metatiles
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_METATILE_MAP_H
+#define HAD_METATILE_MAP_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Charset.h"
+#include "ImageView.h"
+
+// Map of metatiles, which are squares of metatile_size x metatile_size characters.
+// Image is added in bands one metatile high, so only the map has to be kept in memory.
+class MetatileMap {
+public:
+    Charset charset;
+
+    MetatileMap(size_t metatile_size, const CharsetOptions& charset_options, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color);
+
+    [[nodiscard]] size_t get_width() const { return width; }
+    [[nodiscard]] size_t get_height() const { return height; }
+    [[nodiscard]] size_t get_metatile_count() const { return metatiles.size() / (metatile_size * metatile_size); }
+
+    // Add row of metatiles, y is position of band in whole image.
+    void add_band(const ImageView& band, size_t y);
+
+    // Finish charset and write charset, metatiles, and map.
+    // Character indices in metatiles are 8 bit if the charset has at most 256 characters, 16 bit little endian otherwise.
+    // Metatile indices in map are 8 bit if there are at most 256 metatiles, 16 bit little endian otherwise.
+    void save(const std::string& file_name_prefix);
+
+private:
+    size_t metatile_size;
+    CharsetOptions charset_options;
+    std::optional<uint8_t> background_color;
+    std::optional<uint8_t> foreground_color;
+
+    size_t width = 0;
+    size_t height = 0;
+    // Character indices of all metatiles, row by row.
+    std::vector<size_t> metatiles;
+    std::unordered_map<std::u32string, size_t> metatile_index;
+    std::vector<size_t> map;
+
+    size_t add_metatile(const std::u32string& characters);
+};
+
+#endif // HAD_METATILE_MAP_H
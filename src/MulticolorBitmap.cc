@@ -0,0 +1,93 @@
+/*
+  MulticolorBitmap.cc -- C64 multicolor bitmap
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "MulticolorBitmap.h"
+
+#include "Exception.h"
+#include "utils.h"
+
+MulticolorBitmap::MulticolorBitmap(const ImageView& image, std::optional<uint8_t> background_color_) : width(image.get_width() / 4), height(image.get_height() / 8), background_color(0), bitmap(width * height * 8, 0), screen(width, height), colors(width, height) {
+    if (image.get_width() != 160 || image.get_height() != 200) {
+        throw Exception("image dimensions for multicolor bitmap must be 160x200");
+    }
+    if (image.get_image()->get_palette()->size() > 16) {
+        throw Exception("multicolor bitmap needs palette with at most 16 colors");
+    }
+    if (background_color_ == 255) {
+        throw Exception("transparent background not supported for multicolor bitmaps");
+    }
+
+    background_color = background_color_ ? *background_color_ : best_background(Histogram(image, 4, 8));
+
+    for (size_t screen_y = 0; screen_y < height; screen_y++) {
+        for (size_t screen_x = 0; screen_x < width; screen_x++) {
+            std::optional<uint8_t> cell_colors[3];
+
+            auto status = image.encode_multicolor_tile(screen_x * 4, screen_y * 8, 4, 8, background_color, cell_colors, bitmap.data() + (screen_y * width + screen_x) * 8);
+            if (!status.ok()) {
+                throw status.exception();
+            }
+
+            screen.set(screen_x, screen_y, (cell_colors[0].value_or(0) << 4) | cell_colors[1].value_or(0));
+            colors.set(screen_x, screen_y, cell_colors[2].value_or(0));
+        }
+    }
+}
+
+
+uint8_t MulticolorBitmap::best_background(const Histogram& histogram) {
+    auto candidates = histogram.best_backgrounds(3);
+    return candidates.empty() ? 0 : candidates[0];
+}
+
+
+void MulticolorBitmap::save(const std::string& file_name) const {
+    auto data = std::vector<uint8_t>();
+    data.reserve(2 + bitmap.size() + width * height * 2 + 1);
+
+    // Load address $6000.
+    data.push_back(0x00);
+    data.push_back(0x60);
+    data.insert(data.end(), bitmap.begin(), bitmap.end());
+    for (const auto *matrix : {&screen, &colors}) {
+        for (size_t y = 0; y < height; y++) {
+            for (size_t x = 0; x < width; x++) {
+                data.push_back(matrix->get(x, y));
+            }
+        }
+    }
+    data.push_back(background_color);
+
+    save_file(file_name, data);
+}
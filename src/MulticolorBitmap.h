@@ -0,0 +1,72 @@
+/*
+  MulticolorBitmap.h -- C64 multicolor bitmap
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_MULTICOLOR_BITMAP_H
+#define HAD_MULTICOLOR_BITMAP_H
+
+#include <optional>
+
+#include "Histogram.h"
+#include "ImageView.h"
+#include "Matrix.h"
+#include "Status.h"
+
+// Image pixels are multicolor pixels, so a full screen is 160x200 pixels.
+class MulticolorBitmap {
+public:
+    // If background_color is not given, the one causing the fewest color clashes is used.
+    MulticolorBitmap(const ImageView& image, std::optional<uint8_t> background_color);
+
+    [[nodiscard]] size_t get_width() const { return width; }
+    [[nodiscard]] size_t get_height() const { return height; }
+    [[nodiscard]] uint8_t get_background_color() const { return background_color; }
+
+    // Background color causing the fewest color clashes, histogram must be for 4x8 cells.
+    static uint8_t best_background(const Histogram& histogram);
+
+    // Save in Koala Painter format.
+    void save(const std::string& file_name) const;
+
+private:
+    size_t width;
+    size_t height;
+    uint8_t background_color;
+
+public:
+    std::pmr::vector<uint8_t> bitmap;
+    Matrix screen;
+    Matrix colors;
+};
+
+#endif // HAD_MULTICOLOR_BITMAP_H
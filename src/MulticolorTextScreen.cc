@@ -0,0 +1,148 @@
+/*
+  MulticolorTextScreen.cc -- C64 multicolor character screen
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "MulticolorTextScreen.h"
+
+#include <algorithm>
+
+#include "Exception.h"
+#include "utils.h"
+
+MulticolorTextScreen::MulticolorTextScreen(const ImageView& image, std::optional<uint8_t> background_color, const CharsetOptions& charset_options) : charset(charset_options.reduce ? Charset::unlimited : charset_options.max_characters), screen(image.get_width() / 4, image.get_height() / 8), colors(image.get_width() / 4, image.get_height() / 8) {
+    if (image.get_width() % 4 != 0 || image.get_height() % 8 != 0) {
+        throw Exception("image dimensions not multiple of character size");
+    }
+    if (image.get_image()->get_palette()->size() > 16) {
+        throw Exception("multicolor characters need palette with at most 16 colors");
+    }
+    if (charset_options.max_characters > 256) {
+        throw Exception("multicolor text screen supports at most 256 characters");
+    }
+    if (charset_options.transforms != 0) {
+        throw Exception("transforms not supported for multicolor characters");
+    }
+
+    shared_colors = best_shared_colors(Histogram(image, 4, 8), background_color);
+
+    auto indices = std::vector<size_t>(get_width() * get_height());
+
+    for (size_t screen_y = 0; screen_y < get_height(); screen_y++) {
+        for (size_t screen_x = 0; screen_x < get_width(); screen_x++) {
+            std::optional<uint8_t> cell_colors[3] = {shared_colors[1], shared_colors[2], {}};
+            uint8_t tile[8];
+
+            auto status = image.encode_multicolor_tile(screen_x * 4, screen_y * 8, 4, 8, shared_colors[0], cell_colors, tile);
+            if (status.ok() && cell_colors[2].value_or(0) >= 8) {
+                status = Status(Status::CHARACTER_COLOR, image.get_x_offset() + screen_x * 4, image.get_y_offset() + screen_y * 8, *cell_colors[2]);
+            }
+            if (!status.ok()) {
+                throw status.exception();
+            }
+
+            indices[screen_y * get_width() + screen_x] = charset.add(tile);
+            // Bit 3 selects multicolor mode for the character.
+            colors.set(screen_x, screen_y, cell_colors[2].value_or(0) | 0x8);
+        }
+    }
+
+    auto mapping = charset.finish(charset_options);
+    for (size_t screen_y = 0; screen_y < get_height(); screen_y++) {
+        for (size_t screen_x = 0; screen_x < get_width(); screen_x++) {
+            screen.set(screen_x, screen_y, mapping[indices[screen_y * get_width() + screen_x]]);
+        }
+    }
+}
+
+
+std::array<uint8_t, 3> MulticolorTextScreen::best_shared_colors(const Histogram& histogram, std::optional<uint8_t> background_color) {
+    if (background_color == 255) {
+        throw Exception("transparent background not supported for multicolor characters");
+    }
+
+    auto ncolors = std::min(histogram.get_palette_size(), size_t{16});
+
+    // Colors used in each cell.
+    auto masks = std::vector<uint16_t>(histogram.get_columns() * histogram.get_rows());
+    for (size_t cell_y = 0; cell_y < histogram.get_rows(); cell_y++) {
+        for (size_t cell_x = 0; cell_x < histogram.get_columns(); cell_x++) {
+            uint16_t mask = 0;
+            for (size_t color = 0; color < ncolors; color++) {
+                if (histogram.get(cell_x, cell_y, static_cast<uint8_t>(color)) > 0) {
+                    mask |= static_cast<uint16_t>(1 << color);
+                }
+            }
+            masks[cell_y * histogram.get_columns() + cell_x] = mask;
+        }
+    }
+
+    auto best = std::array<uint8_t, 3>{background_color.value_or(0), 0, 0};
+    auto fewest_failures = SIZE_MAX;
+    size_t most_pixels = 0;
+
+    for (size_t background = 0; background < ncolors; background++) {
+        if (background_color && background != *background_color) {
+            continue;
+        }
+        for (size_t color_1 = 0; color_1 < ncolors; color_1++) {
+            for (size_t color_2 = color_1 + 1; color_2 < ncolors; color_2++) {
+                if (color_1 == background || color_2 == background) {
+                    continue;
+                }
+                auto shared = static_cast<uint16_t>((1 << background) | (1 << color_1) | (1 << color_2));
+                size_t failures = 0;
+                for (auto mask : masks) {
+                    // At most one other color, which must be usable in color RAM.
+                    auto rest = static_cast<uint16_t>(mask & ~shared);
+                    failures += (rest & (rest - 1)) != 0 || (rest & 0xff00) != 0;
+                }
+                auto pixels = histogram.get(static_cast<uint8_t>(background)) + histogram.get(static_cast<uint8_t>(color_1)) + histogram.get(static_cast<uint8_t>(color_2));
+                if (failures < fewest_failures || (failures == fewest_failures && pixels > most_pixels)) {
+                    fewest_failures = failures;
+                    most_pixels = pixels;
+                    best = {static_cast<uint8_t>(background), static_cast<uint8_t>(color_1), static_cast<uint8_t>(color_2)};
+                }
+            }
+        }
+    }
+
+    return best;
+}
+
+
+void MulticolorTextScreen::save(const std::string& file_name_prefix, bool full) const {
+    charset.save(file_name_prefix + "-charset.bin", full);
+    screen.save(file_name_prefix + "-screen.bin");
+    colors.save(file_name_prefix + "-colors.bin");
+    save_file(file_name_prefix + "-shared-colors.bin", shared_colors.data(), shared_colors.size());
+}
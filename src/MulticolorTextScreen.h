@@ -0,0 +1,71 @@
+/*
+  MulticolorTextScreen.h -- C64 multicolor character screen
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_MULTICOLOR_TEXT_SCREEN_H
+#define HAD_MULTICOLOR_TEXT_SCREEN_H
+
+#include <array>
+#include <optional>
+
+#include "Charset.h"
+#include "Histogram.h"
+#include "ImageView.h"
+#include "Matrix.h"
+
+// Image pixels are multicolor pixels, so characters are 4x8 pixels.
+class MulticolorTextScreen {
+public:
+    Charset charset;
+    Matrix screen;
+    Matrix colors;
+
+    // If background_color is not given, it is chosen together with the two shared multicolors.
+    MulticolorTextScreen(const ImageView& image, std::optional<uint8_t> background_color, const CharsetOptions& charset_options = {});
+
+    [[nodiscard]] size_t get_width() const { return screen.get_width(); }
+    [[nodiscard]] size_t get_height() const { return screen.get_height(); }
+    // Background ($d021) and shared multicolors ($d022, $d023).
+    [[nodiscard]] const std::array<uint8_t, 3>& get_shared_colors() const { return shared_colors; }
+
+    // Background and multicolors causing fewest cells that can't be represented, histogram must be for 4x8 cells.
+    // Throws if background_color is transparent.
+    static std::array<uint8_t, 3> best_shared_colors(const Histogram& histogram, std::optional<uint8_t> background_color);
+
+    void save(const std::string& file_name_prefix, bool full = false) const;
+
+private:
+    std::array<uint8_t, 3> shared_colors;
+};
+
+#endif // HAD_MULTICOLOR_TEXT_SCREEN_H
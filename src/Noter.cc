@@ -37,11 +37,11 @@
 #include "Exception.h"
 #include "utils.h"
 
-Noter::Noter(size_t w, size_t h) : width(w), height(h), bitmap(std::make_unique<uint8_t[]>(width * height * 16)) {
+Noter::Noter(size_t w, size_t h) : width(w), height(h), bitmap(width * height * 16) {
 }
 
-Noter::Noter(std::shared_ptr<Image> image, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color) : width(image->get_width() / 8), height(image->get_height() / 16), bitmap(std::make_unique<uint8_t[]>(width * height * 16)) {
-    if (image->get_width() % 8 != 0 || image->get_height() % 16 != 0) {
+Noter::Noter(const ImageView& image, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color) : width(image.get_width() / 8), height(image.get_height() / 16), bitmap(width * height * 16) {
+    if (image.get_width() % 8 != 0 || image.get_height() % 16 != 0) {
         throw Exception("image dimensions not multiple of character size");
     }
     
@@ -52,8 +52,9 @@ Noter::Noter(std::shared_ptr<Image> image, std::optional<uint8_t> background_col
             
             uint8_t tile[16];
             
-            for (size_t tile_y = 0; tile_y < 16; tile_y++) {
-                tile[tile_y] = image->get_byte(screen_x * 8, screen_y * 16 + tile_y, bg_color, fg_color);
+            auto status = image.encode_tile(screen_x * 8, screen_y * 16, 8, 16, bg_color, fg_color, tile);
+            if (!status.ok()) {
+                throw status.exception();
             }
             
             set_tile(screen_x, screen_y, tile, bg_color ? *bg_color : 0, fg_color ? *fg_color : 0);
@@ -63,11 +64,11 @@ Noter::Noter(std::shared_ptr<Image> image, std::optional<uint8_t> background_col
 
 
 void Noter::set_tile(size_t x, size_t y, const uint8_t tile[], uint8_t foreground_color, uint8_t background_color) {
-    memcpy(bitmap.get() + (y * width + x) * 16, tile, 16);
+    memcpy(bitmap.data() + (y * width + x) * 16, tile, 16);
 }
 
 
 
 void Noter::save(const std::string file_name_prefix) {
-    save_file(file_name_prefix + ".bin", bitmap.get(), width * height * 16);
+    save_file(file_name_prefix + ".bin", bitmap.data(), bitmap.size());
 }
@@ -35,13 +35,13 @@
 #ifndef HAD_NOTER_H
 #define HAD_NOTER_H
 
-#include "Image.h"
+#include "ImageView.h"
 #include "Matrix.h"
 
 class Noter {
 public:
     Noter(size_t width, size_t height);
-    Noter(std::shared_ptr<Image> image, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color);
+    Noter(const ImageView& image, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color);
     
     size_t get_width() const { return width; }
     size_t get_height() const { return height; }
@@ -53,7 +53,7 @@ public:
 private:
     size_t width;
     size_t height;
-    std::unique_ptr<uint8_t[]> bitmap;
+    std::pmr::vector<uint8_t> bitmap;
 };
 
 #endif // HAD_NOTER_H
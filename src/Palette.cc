@@ -32,10 +32,19 @@
   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
-#include "Exception.h"
 #include "Palette.h"
 
-Palette Palette::c64_colodore = Palette({
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <filesystem>
+#include <sstream>
+
+#include "Exception.h"
+#include "utils.h"
+
+const std::vector<uint32_t> Palette::c64_colodore = {
     0x000000,
     0xFFFFFF,
     0x813338,
@@ -52,9 +61,66 @@ Palette Palette::c64_colodore = Palette({
     0xA9FF9F,
     0x706DEB,
     0xB2B2B2
-});
+};
+
+const std::vector<uint32_t> Palette::c64_ccs64 = {
+    0x101010,
+    0xFFFFFF,
+    0xE04040,
+    0x60FFFF,
+    0xE060E0,
+    0x40E040,
+    0x4040E0,
+    0xFFFF40,
+    0xE0A040,
+    0x9C7448,
+    0xFFA0A0,
+    0x545454,
+    0x888888,
+    0xA0FFA0,
+    0xA0A0FF,
+    0xC0C0C0
+};
+
+const std::vector<uint32_t> Palette::c64_pepto = {
+    0x000000,
+    0xFFFFFF,
+    0x68372B,
+    0x70A4B2,
+    0x6F3D86,
+    0x588D43,
+    0x352879,
+    0xB8C76F,
+    0x6F4F25,
+    0x433900,
+    0x9A6759,
+    0x444444,
+    0x6C6C6C,
+    0x9AD284,
+    0x6C5EB5,
+    0x959595
+};
+
+const std::vector<uint32_t> Palette::c64_vice = {
+    0x000000,
+    0xFDFEFC,
+    0xBE1A24,
+    0x30E6C6,
+    0xB41AE2,
+    0x1FD21E,
+    0x211BAE,
+    0xDFF60A,
+    0xB84104,
+    0x6A3304,
+    0xFE4A57,
+    0x424540,
+    0x70746F,
+    0x59FE59,
+    0x5F53FE,
+    0xA4A7A2
+};
 
-Palette Palette::zx_spectrum = Palette({
+const std::vector<uint32_t> Palette::zx_spectrum = {
     0x000000, // black
     0x0022c7, // blue
     0xd62816, // red
@@ -71,34 +137,259 @@ Palette Palette::zx_spectrum = Palette({
     0x00fbfe, // bright cyan
     0xfffc36, // bright yellow
     0xffffff  // bright white
-});
+};
+
+const std::vector<uint32_t> Palette::zx_spectrum_cd = {
+    0x000000, // black
+    0x0000cd, // blue
+    0xcd0000, // red
+    0xcd00cd, // magenta
+    0x00cd00, // green
+    0x00cdcd, // cyan
+    0xcdcd00, // yellow
+    0xcdcdcd, // white
+    0x000000, // bright black
+    0x0000ff, // bright blue
+    0xff0000, // bright red
+    0xff00ff, // bright magenta
+    0x00ff00, // bright green
+    0x00ffff, // bright cyan
+    0xffff00, // bright yellow
+    0xffffff  // bright white
+};
+
+const std::vector<uint32_t> Palette::zx_spectrum_d7 = {
+    0x000000, // black
+    0x0000d7, // blue
+    0xd70000, // red
+    0xd700d7, // magenta
+    0x00d700, // green
+    0x00d7d7, // cyan
+    0xd7d700, // yellow
+    0xd7d7d7, // white
+    0x000000, // bright black
+    0x0000ff, // bright blue
+    0xff0000, // bright red
+    0xff00ff, // bright magenta
+    0x00ff00, // bright green
+    0x00ffff, // bright cyan
+    0xffff00, // bright yellow
+    0xffffff  // bright white
+};
+
+Palette::Palette(std::vector<uint32_t> entries_, uint8_t transparent_index_) : transparent_index(transparent_index_), entries(std::move(entries_)) {
+    if (entries.empty() || entries.size() > 256) {
+        throw Exception("invalid palette size %zu", entries.size());
+    }
+
+    for (size_t index = 0; index < entries.size(); index++) {
+        // First entry wins for duplicate colors.
+        indices.emplace(entries[index], static_cast<uint8_t>(index));
+        lab_entries.push_back(to_lab(entries[index]));
+    }
+}
+
+std::optional<uint8_t> Palette::find(uint32_t color) const {
+    auto it = indices.find(color);
 
-Palette::Palette(uint8_t size, uint8_t transparent_index_) : transparent_index(transparent_index_), entries(size) { }
+    if (it == indices.end()) {
+        return {};
+    }
 
-Palette::Palette(const std::vector<uint32_t> entries_, uint8_t transparent_index_) : transparent_index(transparent_index_), entries(entries_) { }
+    return it->second;
+}
 
 uint8_t Palette::lookup(uint32_t color) const {
-    for (uint8_t index = 0; index < entries.size(); index++) {
-        if (entries[index] == color) {
-            return index;
+    auto index = find(color);
+
+    if (!index) {
+        throw Exception("invalid color $%06x", color);
+    }
+
+    return *index;
+}
+
+uint8_t Palette::lookup_nearest(uint32_t color) const {
+    auto it = indices.find(color);
+    if (it != indices.end()) {
+        return it->second;
+    }
+
+    return get_nearest_cube()[cube_index(color >> 16, (color >> 8) & 0xff, color & 0xff)];
+}
+
+const uint8_t *Palette::get_nearest_cube() const {
+    std::call_once(cube_once, [this] { build_cube(); });
+    return cube.data();
+}
+
+uint8_t Palette::find_nearest(const Lab& color) const {
+    uint8_t best_index = 0;
+    auto best_distance = std::numeric_limits<float>::max();
+
+    for (size_t index = 0; index < lab_entries.size(); index++) {
+        if (index == transparent_index) {
+            continue;
+        }
+        auto distance = color.distance(lab_entries[index]);
+        if (distance < best_distance) {
+            best_distance = distance;
+            best_index = static_cast<uint8_t>(index);
+        }
+    }
+
+    return best_index;
+}
+
+void Palette::build_cube() const {
+    constexpr auto size = 1u << cube_bits;
+    constexpr auto shift = 8 - cube_bits;
+    constexpr auto center = 1u << (shift - 1);
+
+    cube.resize(size * size * size);
+    for (uint32_t r = 0; r < size; r++) {
+        for (uint32_t g = 0; g < size; g++) {
+            for (uint32_t b = 0; b < size; b++) {
+                auto color = (((r << shift) | center) << 16) | (((g << shift) | center) << 8) | ((b << shift) | center);
+                cube[(r * size + g) * size + b] = find_nearest(to_lab(color));
+            }
         }
     }
-    
-    throw Exception("invalid color $%06x", color);
+}
+
+Palette::Lab Palette::to_lab(uint32_t color) {
+    auto linear = [](uint32_t value) {
+        auto v = static_cast<float>(value) / 255.0f;
+        return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+    };
+    auto r = linear(color >> 16);
+    auto g = linear((color >> 8) & 0xff);
+    auto b = linear(color & 0xff);
+
+    // sRGB to XYZ, relative to D65 white point
+    auto x = (0.4124f * r + 0.3576f * g + 0.1805f * b) / 0.95047f;
+    auto y = 0.2126f * r + 0.7152f * g + 0.0722f * b;
+    auto z = (0.0193f * r + 0.1192f * g + 0.9505f * b) / 1.08883f;
+
+    auto f = [](float t) {
+        return t > 0.008856f ? std::cbrt(t) : 7.787f * t + 16.0f / 116.0f;
+    };
+    auto fx = f(x);
+    auto fy = f(y);
+    auto fz = f(z);
+
+    return Lab{116.0f * fy - 16.0f, 500.0f * (fx - fy), 200.0f * (fy - fz)};
 }
 
 uint32_t Palette::get(uint8_t index) const {
-    if (index > entries.size()) {
+    if (index >= entries.size()) {
         throw Exception("palette index out of range");
     }
     
     return entries[index];
 }
 
-uint32_t& Palette::operator [](uint8_t index) {
-    if (index > entries.size()) {
-        throw Exception("palette index out of range");
+std::shared_ptr<const Palette> Palette::load(const std::string& file_name) {
+    auto data = load_file(file_name);
+    auto extension = std::filesystem::path(file_name).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    if (extension == ".act") {
+        return load_act(file_name, data);
     }
-        
-    return entries[index];
+    else if (extension == ".gpl" || (data.size() >= 12 && memcmp(data.data(), "GIMP Palette", 12) == 0)) {
+        return load_gpl(file_name, data);
+    }
+    else {
+        return load_hex(file_name, data);
+    }
+}
+
+// Adobe Color Table: 256 RGB triples, optionally followed by number of colors and transparent index (big endian).
+std::shared_ptr<const Palette> Palette::load_act(const std::string& file_name, const std::vector<uint8_t>& data) {
+    if (data.size() != 768 && data.size() != 772) {
+        throw Exception("invalid size %zu of ACT palette '%s'", data.size(), file_name.c_str());
+    }
+
+    size_t count = 256;
+    uint8_t transparent = 255;
+    if (data.size() == 772) {
+        count = (data[768] << 8) | data[769];
+        auto transparent_entry = (data[770] << 8) | data[771];
+        if (count == 0 || count > 256) {
+            throw Exception("invalid number of colors %zu in ACT palette '%s'", count, file_name.c_str());
+        }
+        if (transparent_entry < 256) {
+            transparent = static_cast<uint8_t>(transparent_entry);
+        }
+    }
+
+    auto colors = std::vector<uint32_t>();
+    for (size_t index = 0; index < count; index++) {
+        colors.push_back((data[index * 3] << 16) | (data[index * 3 + 1] << 8) | data[index * 3 + 2]);
+    }
+
+    return std::make_shared<const Palette>(colors, transparent);
+}
+
+std::shared_ptr<const Palette> Palette::load_gpl(const std::string& file_name, const std::vector<uint8_t>& data) {
+    auto stream = std::istringstream(std::string(data.begin(), data.end()));
+    std::string line;
+    size_t line_number = 0;
+    auto colors = std::vector<uint32_t>();
+
+    while (std::getline(stream, line)) {
+        line_number++;
+        if (line_number == 1) {
+            if (line.compare(0, 12, "GIMP Palette") != 0) {
+                throw Exception("'%s' is not a GIMP palette", file_name.c_str());
+            }
+            continue;
+        }
+        if (line.empty() || line[0] == '#' || line.compare(0, 5, "Name:") == 0 || line.compare(0, 8, "Columns:") == 0) {
+            continue;
+        }
+
+        unsigned int r, g, b;
+        if (sscanf(line.c_str(), "%u %u %u", &r, &g, &b) != 3 || r > 255 || g > 255 || b > 255) {
+            throw Exception("invalid color in GIMP palette '%s', line %zu", file_name.c_str(), line_number);
+        }
+        colors.push_back((r << 16) | (g << 8) | b);
+    }
+
+    return std::make_shared<const Palette>(colors);
+}
+
+// One color per line as RRGGBB, optionally prefixed with '#', '$', or '0x'.
+std::shared_ptr<const Palette> Palette::load_hex(const std::string& file_name, const std::vector<uint8_t>& data) {
+    auto stream = std::istringstream(std::string(data.begin(), data.end()));
+    std::string line;
+    size_t line_number = 0;
+    auto colors = std::vector<uint32_t>();
+
+    while (std::getline(stream, line)) {
+        line_number++;
+
+        auto start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == ';') {
+            continue;
+        }
+        if (line[start] == '#' || line[start] == '$') {
+            start += 1;
+        }
+        else if (line.compare(start, 2, "0x") == 0 || line.compare(start, 2, "0X") == 0) {
+            start += 2;
+        }
+
+        auto end = line.find_first_not_of("0123456789abcdefABCDEF", start);
+        if (end == std::string::npos) {
+            end = line.length();
+        }
+        if (end - start != 6 || line.find_first_not_of(" \t\r", end) != std::string::npos) {
+            throw Exception("invalid color in palette '%s', line %zu", file_name.c_str(), line_number);
+        }
+        colors.push_back(static_cast<uint32_t>(std::stoul(line.substr(start, 6), nullptr, 16)));
+    }
+
+    return std::make_shared<const Palette>(colors);
 }
@@ -36,29 +36,82 @@
 #define HAD_PALETTE_H
 
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 class Palette {
 public:
-    Palette(uint8_t size, uint8_t transparent_index = 255);
-    Palette(const std::vector<uint32_t> entries, uint8_t transparent_index = 255);
+    // Color in CIE L*a*b* space, where euclidean distance approximates perceived difference.
+    class Lab {
+    public:
+        float l;
+        float a;
+        float b;
 
+        [[nodiscard]] float distance(const Lab& other) const {
+            auto dl = l - other.l;
+            auto da = a - other.a;
+            auto db = b - other.b;
+            return dl * dl + da * da + db * db;
+        }
+    };
+
+    explicit Palette(std::vector<uint32_t> entries, uint8_t transparent_index = 255);
+    Palette(const Palette&) = delete;
+    Palette& operator=(const Palette&) = delete;
+
+    std::optional<uint8_t> find(uint32_t color) const;
     uint8_t lookup(uint32_t color) const;
+    // Index of perceptually closest color; exact matches are always found.
+    uint8_t lookup_nearest(uint32_t color) const;
+
+    // Table of closest colors, indexed by cube_index(), computed on first use.
+    const uint8_t *get_nearest_cube() const;
+    static size_t cube_index(uint32_t r, uint32_t g, uint32_t b) {
+        return ((r >> (8 - cube_bits)) << (2 * cube_bits)) | ((g >> (8 - cube_bits)) << cube_bits) | (b >> (8 - cube_bits));
+    }
     
     size_t size() const { return entries.size(); }
     
     uint32_t get(uint8_t index) const;
     
     uint32_t operator [](uint8_t index) const { return get(index); }
-    uint32_t& operator [](uint8_t index);
+    const Lab& get_lab(uint8_t index) const { return lab_entries[index]; }
+
+    static std::shared_ptr<const Palette> load(const std::string& file_name);
+    static Lab to_lab(uint32_t color);
 
-    static Palette c64_colodore;
-    static Palette zx_spectrum;
+    static const std::vector<uint32_t> c64_colodore;
+    static const std::vector<uint32_t> c64_ccs64;
+    static const std::vector<uint32_t> c64_pepto;
+    static const std::vector<uint32_t> c64_vice;
+    static const std::vector<uint32_t> zx_spectrum;
+    static const std::vector<uint32_t> zx_spectrum_cd;
+    static const std::vector<uint32_t> zx_spectrum_d7;
 
-    uint8_t transparent_index;
+    const uint8_t transparent_index;
 
 private:
+    static std::shared_ptr<const Palette> load_act(const std::string& file_name, const std::vector<uint8_t>& data);
+    static std::shared_ptr<const Palette> load_gpl(const std::string& file_name, const std::vector<uint8_t>& data);
+    static std::shared_ptr<const Palette> load_hex(const std::string& file_name, const std::vector<uint8_t>& data);
+
+    uint8_t find_nearest(const Lab& color) const;
+    void build_cube() const;
+
+    // Colors are quantized to 5 bits per channel for the nearest color cube.
+    static constexpr unsigned int cube_bits = 5;
+
     std::vector<uint32_t> entries;
+    std::vector<Lab> lab_entries;
+    std::unordered_map<uint32_t, uint8_t> indices;
+
+    mutable std::once_flag cube_once;
+    mutable std::vector<uint8_t> cube;
 };
 
 #endif // HAD_PALETTE_H
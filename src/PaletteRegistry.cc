@@ -0,0 +1,131 @@
+/*
+  PaletteRegistry.cc -- shared immutable palettes
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "PaletteRegistry.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+const std::vector<std::vector<std::string>> PaletteRegistry::families = {
+    {"c64-colodore", "c64-pepto", "c64-vice", "c64-ccs64"},
+    {"zx-spectrum", "zx-spectrum-cd", "zx-spectrum-d7"}
+};
+
+std::shared_ptr<const Palette> PaletteRegistry::get(const std::string& name) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const Palette>> palettes = {
+        {"c64-ccs64", std::make_shared<const Palette>(Palette::c64_ccs64)},
+        {"c64-colodore", std::make_shared<const Palette>(Palette::c64_colodore)},
+        {"c64-pepto", std::make_shared<const Palette>(Palette::c64_pepto)},
+        {"c64-vice", std::make_shared<const Palette>(Palette::c64_vice)},
+        {"zx-spectrum", std::make_shared<const Palette>(Palette::zx_spectrum)},
+        {"zx-spectrum-cd", std::make_shared<const Palette>(Palette::zx_spectrum_cd)},
+        {"zx-spectrum-d7", std::make_shared<const Palette>(Palette::zx_spectrum_d7)}
+    };
+
+    auto lock = std::lock_guard(mutex);
+
+    auto it = palettes.find(name);
+    if (it != palettes.end()) {
+        return it->second;
+    }
+
+    // Files are interned under their canonical path, so different spellings share one palette.
+    auto key = std::filesystem::weakly_canonical(name).string();
+    it = palettes.find(key);
+    if (it == palettes.end()) {
+        it = palettes.emplace(key, Palette::load(name)).first;
+    }
+    palettes[name] = it->second;
+    return it->second;
+}
+
+
+std::vector<std::shared_ptr<const Palette>> PaletteRegistry::get_variants(const std::shared_ptr<const Palette>& palette) {
+    auto variants = std::vector<std::shared_ptr<const Palette>>{palette};
+
+    for (const auto& family : families) {
+        auto members = std::vector<std::shared_ptr<const Palette>>();
+        auto found = false;
+        for (const auto& name : family) {
+            auto member = get(name);
+            if (member == palette) {
+                found = true;
+            }
+            else {
+                members.push_back(member);
+            }
+        }
+        if (found) {
+            variants.insert(variants.end(), members.begin(), members.end());
+            break;
+        }
+    }
+
+    return variants;
+}
+
+
+std::shared_ptr<const Palette> PaletteRegistry::detect(const std::unordered_map<uint32_t, size_t>& histogram, const std::shared_ptr<const Palette>& palette) {
+    auto colors = std::vector<std::pair<Palette::Lab, size_t>>();
+    for (const auto& [color, count] : histogram) {
+        colors.emplace_back(Palette::to_lab(color), count);
+    }
+
+    std::shared_ptr<const Palette> best_palette;
+    auto best_error = std::numeric_limits<double>::max();
+
+    // Score is the pixel weighted distance of each color to its closest entry, exact matches cost nothing.
+    for (const auto& candidate : get_variants(palette)) {
+        double error = 0;
+        for (const auto& [lab, count] : colors) {
+            auto min_distance = std::numeric_limits<float>::max();
+            for (size_t index = 0; index < candidate->size(); index++) {
+                if (index != candidate->transparent_index) {
+                    min_distance = std::min(min_distance, lab.distance(candidate->get_lab(index)));
+                }
+            }
+            error += static_cast<double>(min_distance) * count;
+        }
+        if (error < best_error) {
+            best_error = error;
+            best_palette = candidate;
+        }
+    }
+
+    return best_palette;
+}
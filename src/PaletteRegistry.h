@@ -0,0 +1,64 @@
+/*
+  PaletteRegistry.h -- shared immutable palettes
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_PALETTE_REGISTRY_H
+#define HAD_PALETTE_REGISTRY_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Palette.h"
+
+// Palettes are created once per process and shared by all images using them.
+class PaletteRegistry {
+public:
+    // name is either the name of a built-in palette or the name of a palette file.
+    static std::shared_ptr<const Palette> get(const std::string& name);
+
+    static std::shared_ptr<const Palette> c64_colodore() { return get("c64-colodore"); }
+    static std::shared_ptr<const Palette> zx_spectrum() { return get("zx-spectrum"); }
+
+    // Built-in palettes with the same colors in the same order as palette, as used by different emulators.
+    static std::vector<std::shared_ptr<const Palette>> get_variants(const std::shared_ptr<const Palette>& palette);
+
+    // Variant of palette that best matches the colors of an image.
+    static std::shared_ptr<const Palette> detect(const std::unordered_map<uint32_t, size_t>& histogram, const std::shared_ptr<const Palette>& palette);
+
+private:
+    static const std::vector<std::vector<std::string>> families;
+};
+
+#endif // HAD_PALETTE_REGISTRY_H
@@ -0,0 +1,167 @@
+/*
+  PetsciiScreen.cc -- text screen using fixed charset
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "PetsciiScreen.h"
+
+#include <bitset>
+#include <cstring>
+#include <limits>
+
+#include "Exception.h"
+#include "utils.h"
+
+void PetsciiScreen::match_cell(const uint8_t *pixels, size_t row_length, uint8_t& character, uint8_t& color) const {
+    // Bit masks of pixels of each color in cell, in the bit order of characters.
+    uint8_t cell_colors[64];
+    uint64_t masks[64];
+    size_t pixel_counts[64];
+    size_t count = 0;
+
+    for (size_t y = 0; y < 8; y++) {
+        for (size_t x = 0; x < 8; x++) {
+            auto pixel = pixels[y * row_length + x];
+            if (pixel >= palette_size) {
+                // Transparent pixels show background.
+                pixel = background_color;
+            }
+            size_t i = 0;
+            while (i < count && cell_colors[i] != pixel) {
+                i++;
+            }
+            if (i == count) {
+                cell_colors[count] = pixel;
+                masks[count] = 0;
+                count++;
+            }
+            masks[i] |= uint64_t{1} << (y * 8 + 7 - x);
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        pixel_counts[i] = std::bitset<64>(masks[i]).count();
+    }
+
+    auto foreground_colors = std::min(palette_size, size_t{16});
+    auto best_cost = std::numeric_limits<float>::max();
+    size_t set_pixels[64];
+
+    for (size_t index = 0; index < characters.size(); index++) {
+        auto bits = characters[index];
+        // Error of pixels showing background.
+        auto background_cost = 0.0f;
+        for (size_t i = 0; i < count; i++) {
+            set_pixels[i] = std::bitset<64>(bits & masks[i]).count();
+            background_cost += static_cast<float>(pixel_counts[i] - set_pixels[i]) * distances[cell_colors[i] * palette_size + background_color];
+        }
+        if (background_cost >= best_cost) {
+            continue;
+        }
+
+        for (size_t foreground_color = 0; foreground_color < foreground_colors; foreground_color++) {
+            auto cost = background_cost;
+            for (size_t i = 0; i < count; i++) {
+                cost += static_cast<float>(set_pixels[i]) * distances[cell_colors[i] * palette_size + foreground_color];
+            }
+            if (cost < best_cost) {
+                best_cost = cost;
+                character = index;
+                color = foreground_color;
+            }
+        }
+    }
+}
+
+
+PetsciiScreen::PetsciiScreen(const ImageView& image, const std::vector<uint8_t>& charset, uint8_t background_color) : screen(image.get_width() / 8, image.get_height() / 8), colors(image.get_width() / 8, image.get_height() / 8), background_color(background_color) {
+    if (image.get_width() % 8 != 0 || image.get_height() % 8 != 0) {
+        throw Exception("image dimensions not multiple of 8");
+    }
+    if (charset.empty() || charset.size() % 8 != 0 || charset.size() > 256 * 8) {
+        throw Exception("invalid charset size %zu", charset.size());
+    }
+    const auto& palette = *image.get_image()->get_palette();
+    palette_size = palette.size();
+    if (background_color >= palette_size) {
+        throw Exception("invalid background color %d", background_color);
+    }
+
+    distances.resize(palette_size * palette_size);
+    for (size_t color = 0; color < palette_size; color++) {
+        for (size_t other = 0; other < palette_size; other++) {
+            distances[color * palette_size + other] = palette.get_lab(color).distance(palette.get_lab(other));
+        }
+    }
+
+    auto count = charset.size() / 8;
+    characters.resize(count);
+    memcpy(characters.data(), charset.data(), charset.size());
+    if (count <= 128) {
+        // Unused characters between charset and its reverse variants duplicate the first character, which wins ties.
+        characters.resize(128 + count, characters[0]);
+        for (size_t index = 0; index < count; index++) {
+            characters[index + 128] = ~characters[index];
+        }
+    }
+
+    // Cells are matched in parallel, so collect results before storing them in screen and colors.
+    auto matched_characters = std::vector<uint8_t>(get_width() * get_height());
+    auto matched_colors = std::vector<uint8_t>(get_width() * get_height());
+
+    parallel_for(get_height(), [&](size_t begin, size_t end) {
+        auto rows = std::vector<uint8_t>(image.get_width() * 8);
+
+        for (size_t screen_y = begin; screen_y < end; screen_y++) {
+            for (size_t y = 0; y < 8; y++) {
+                image.get_row(screen_y * 8 + y, rows.data() + y * image.get_width());
+            }
+            for (size_t screen_x = 0; screen_x < get_width(); screen_x++) {
+                auto index = screen_y * get_width() + screen_x;
+                match_cell(rows.data() + screen_x * 8, image.get_width(), matched_characters[index], matched_colors[index]);
+            }
+        }
+    });
+
+    for (size_t screen_y = 0; screen_y < get_height(); screen_y++) {
+        for (size_t screen_x = 0; screen_x < get_width(); screen_x++) {
+            auto index = screen_y * get_width() + screen_x;
+            screen.set(screen_x, screen_y, matched_characters[index]);
+            colors.set(screen_x, screen_y, matched_colors[index]);
+        }
+    }
+}
+
+
+void PetsciiScreen::save(const std::string& file_name_prefix) const {
+    screen.save(file_name_prefix + "-screen.bin");
+    colors.save(file_name_prefix + "-colors.bin");
+}
@@ -0,0 +1,70 @@
+/*
+  PetsciiScreen.h -- text screen using fixed charset
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_PETSCII_SCREEN_H
+#define HAD_PETSCII_SCREEN_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ImageView.h"
+#include "Matrix.h"
+
+// Text screen approximating image with characters from a fixed charset, like the C64 ROM charset.
+class PetsciiScreen {
+public:
+    Matrix screen;
+    Matrix colors;
+
+    // Charset has up to 256 characters; if it has at most 128, their reverse variants are used as characters 128-255.
+    PetsciiScreen(const ImageView& image, const std::vector<uint8_t>& charset, uint8_t background_color);
+
+    [[nodiscard]] size_t get_width() const { return screen.get_width(); }
+    [[nodiscard]] size_t get_height() const { return screen.get_height(); }
+
+    void save(const std::string& file_name_prefix) const;
+
+private:
+    std::vector<uint64_t> characters;
+    size_t palette_size;
+    uint8_t background_color;
+    // Perceived difference between palette colors, indexed by color * palette_size + other color.
+    std::vector<float> distances;
+
+    // Find character and foreground color closest to cell, pixels are row_length apart.
+    void match_cell(const uint8_t *pixels, size_t row_length, uint8_t& character, uint8_t& color) const;
+};
+
+#endif // HAD_PETSCII_SCREEN_H
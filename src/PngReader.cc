@@ -0,0 +1,146 @@
+/*
+  PngReader.cc -- read PNG image row by row
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "PngReader.h"
+
+#include "Exception.h"
+#include "utils.h"
+
+PngReader::PngReader(std::string file_name_) : file_name(std::move(file_name_)), png_ptr(nullptr), info_ptr(nullptr), next_row(0) {
+    fp = make_shared_file(file_name, "rb");
+    
+    uint8_t header[8];
+
+    if (fread(header, 8, 1, fp.get()) != 1) {
+        throw Exception("can't read PNG header from '%s'", file_name.c_str()).append_system_error();
+    }
+
+    if (png_sig_cmp(header, 0, 8) != 0) {
+        throw Exception("'%s' is not a PNG image", file_name.c_str());
+    }
+    
+    png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+
+    if (png_ptr == nullptr) {
+        throw Exception("can't create PNG reader");
+    }
+
+    info_ptr = png_create_info_struct(png_ptr);
+
+    if (info_ptr == nullptr) {
+        png_destroy_read_struct(&png_ptr, nullptr, nullptr);
+        throw Exception("can't create PNG info");
+    }
+
+    if (setjmp(png_jmpbuf(png_ptr))) {
+        png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+        throw Exception("can't read PNG image '%s'", file_name.c_str()); // TODO: error details
+    }
+
+    png_init_io(png_ptr, fp.get());
+    png_set_sig_bytes(png_ptr, 8);
+    png_read_info(png_ptr, info_ptr);
+    
+    width = png_get_image_width(png_ptr, info_ptr);
+    height = png_get_image_height(png_ptr, info_ptr);
+    auto color_type = png_get_color_type(png_ptr, info_ptr);
+    auto bit_depth = png_get_bit_depth(png_ptr, info_ptr);
+    transparency = (color_type & PNG_COLOR_MASK_ALPHA) != 0 || png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS) != 0;
+    
+    if (color_type == PNG_COLOR_TYPE_PALETTE) {
+        png_set_palette_to_rgb(png_ptr);
+    }
+    else if (color_type == PNG_COLOR_TYPE_GRAY) {
+        png_set_gray_to_rgb(png_ptr);
+    }
+    if (bit_depth == 16) {
+        png_set_strip_16(png_ptr);
+    }
+    
+    if (color_type == PNG_COLOR_TYPE_RGB_ALPHA || color_type == PNG_COLOR_TYPE_GRAY_ALPHA) {
+        //png_set_invert_alpha(png_ptr);
+    }
+    else {
+        png_set_filler(png_ptr, 255, PNG_FILLER_AFTER);
+    }
+
+    interlaced = png_get_interlace_type(png_ptr, info_ptr) != PNG_INTERLACE_NONE;
+    if (interlaced) {
+        png_set_interlace_handling(png_ptr);
+    }
+
+    png_read_update_info(png_ptr, info_ptr);
+
+    if (png_get_rowbytes(png_ptr, info_ptr) != width * 4) {
+        auto row_bytes = png_get_rowbytes(png_ptr, info_ptr);
+        png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+        throw Exception("unexpected row size %zu", row_bytes);
+    }
+
+    buffer.resize(interlaced ? width * height * 4 : width * 4);
+
+    if (interlaced) {
+        auto rows = std::pmr::vector<png_bytep>(height);
+        for (size_t i = 0; i < height; i++) {
+            rows[i] = buffer.data() + i * width * 4;
+        }
+        png_read_image(png_ptr, rows.data());
+    }
+}
+
+
+PngReader::~PngReader() {
+    if (png_ptr != nullptr) {
+        png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+    }
+}
+
+
+const uint8_t *PngReader::read_row() {
+    if (next_row >= height) {
+        throw Exception("no more rows in PNG image '%s'", file_name.c_str());
+    }
+
+    auto y = next_row++;
+
+    if (interlaced) {
+        return buffer.data() + y * width * 4;
+    }
+
+    if (setjmp(png_jmpbuf(png_ptr))) {
+        throw Exception("can't read PNG image '%s'", file_name.c_str()); // TODO: error details
+    }
+    png_read_row(png_ptr, buffer.data(), nullptr);
+    return buffer.data();
+}
@@ -0,0 +1,77 @@
+/*
+  PngReader.h -- read PNG image row by row
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_PNG_READER_H
+#define HAD_PNG_READER_H
+
+#include <cstdio>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include <png.h>
+
+// Decodes PNG image into 8 bit RGBA rows.
+class PngReader {
+public:
+    explicit PngReader(std::string file_name);
+    ~PngReader();
+
+    PngReader(const PngReader&) = delete;
+    PngReader& operator=(const PngReader&) = delete;
+
+    [[nodiscard]] size_t get_width() const { return width; }
+    [[nodiscard]] size_t get_height() const { return height; }
+    [[nodiscard]] bool has_transparency() const { return transparency; }
+
+    // Returns next row, 4 bytes per pixel.
+    const uint8_t *read_row();
+
+private:
+    std::string file_name;
+    std::shared_ptr<std::FILE> fp;
+    png_structp png_ptr;
+    png_infop info_ptr;
+
+    size_t width;
+    size_t height;
+    bool transparency;
+    bool interlaced;
+    size_t next_row;
+    // Non-interlaced images are decoded one row at a time, interlaced images need all rows in memory.
+    std::pmr::vector<uint8_t> buffer;
+};
+
+#endif // HAD_PNG_READER_H
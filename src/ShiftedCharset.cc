@@ -0,0 +1,141 @@
+/*
+  ShiftedCharset.cc -- charset of image shifted by 0-7 pixels
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ShiftedCharset.h"
+
+#include <cstring>
+
+#include "Bitmap.h"
+#include "Exception.h"
+#include "utils.h"
+
+// Each byte of a tile is one row, leftmost pixel in most significant bit, top row in least significant byte.
+static uint64_t shift_rows_left(uint64_t tile, uint64_t right, size_t x_shift) {
+    if (x_shift == 0) {
+        return tile;
+    }
+    // Shift all eight rows at once, masking out bits that crossed into the neighboring row.
+    auto kept = (0xffULL << x_shift) & 0xff;
+    auto filled = 0xffULL >> (8 - x_shift);
+    return ((tile << x_shift) & (kept * 0x0101010101010101ULL)) | ((right >> (8 - x_shift)) & (filled * 0x0101010101010101ULL));
+}
+
+
+uint64_t ShiftedCharset::shift(uint64_t tile, uint64_t right, uint64_t below, uint64_t below_right, size_t x_shift, size_t y_shift) {
+    auto top = shift_rows_left(tile, right, x_shift);
+    if (y_shift == 0) {
+        return top;
+    }
+    auto bottom = shift_rows_left(below, below_right, x_shift);
+    return (top >> (y_shift * 8)) | (bottom << ((8 - y_shift) * 8));
+}
+
+
+ShiftedCharset::ShiftedCharset(const ImageView& image, uint8_t background_color, std::optional<uint8_t> foreground_color, bool vertical, const CharsetOptions& charset_options) : charset(charset_options.reduce ? Charset::unlimited : charset_options.max_characters), width(image.get_width() / 8), height(image.get_height() / 8), vertical(vertical), charset_options(charset_options) {
+    if (charset_options.transforms != 0) {
+        throw Exception("transforms not supported for shifted charsets");
+    }
+
+    auto bitmap = Bitmap(image, Bitmap::C64, background_color, foreground_color);
+    auto cells = width * height;
+    auto tiles = std::vector<uint64_t>(cells);
+    memcpy(tiles.data(), bitmap.bitmap.data(), cells * 8);
+
+    auto tile = [&](size_t x, size_t y) -> uint64_t {
+        return x < width && y < height ? tiles[y * width + x] : 0;
+    };
+    // Bitmap screen holds the color of set pixels in the upper nibble.
+    auto color = [&](size_t x, size_t y) -> uint8_t {
+        return bitmap.screen.get(x, y) >> 4;
+    };
+
+    auto shifted = std::vector<uint64_t>(get_shift_count() * cells);
+    colors.resize(shifted.size());
+    parallel_for(get_shift_count(), [&](size_t begin, size_t end) {
+        for (auto shift_index = begin; shift_index < end; shift_index++) {
+            auto x_shift = shift_index % 8;
+            auto y_shift = shift_index / 8;
+            auto screen = shifted.data() + shift_index * cells;
+            auto screen_colors = colors.data() + shift_index * cells;
+            for (size_t y = 0; y < height; y++) {
+                for (size_t x = 0; x < width; x++) {
+                    screen[y * width + x] = shift(tile(x, y), tile(x + 1, y), tile(x, y + 1), tile(x + 1, y + 1), x_shift, y_shift);
+
+                    // Take the color from the cells contributing foreground pixels, which must all agree.
+                    std::optional<uint8_t> foreground_color;
+                    const uint64_t parts[] = {
+                        shift(tile(x, y), 0, 0, 0, x_shift, y_shift),
+                        shift(0, tile(x + 1, y), 0, 0, x_shift, y_shift),
+                        shift(0, 0, tile(x, y + 1), 0, x_shift, y_shift),
+                        shift(0, 0, 0, tile(x + 1, y + 1), x_shift, y_shift)
+                    };
+                    for (size_t part = 0; part < 4; part++) {
+                        if (parts[part] == 0) {
+                            continue;
+                        }
+                        auto part_color = color(x + part % 2, y + part / 2);
+                        if (foreground_color && *foreground_color != part_color) {
+                            throw Exception("different foreground colors in shifted character (shift %zu,%zu)", x_shift, y_shift).set_position(x * 8, y * 8);
+                        }
+                        foreground_color = part_color;
+                    }
+                    screen_colors[y * width + x] = foreground_color.value_or(0);
+                }
+            }
+        }
+    });
+
+    indices.resize(shifted.size());
+    for (size_t i = 0; i < shifted.size(); i++) {
+        indices[i] = charset.add(reinterpret_cast<const uint8_t *>(&shifted[i]));
+    }
+}
+
+
+void ShiftedCharset::save(const std::string& file_name_prefix) {
+    auto mapping = charset.finish(charset_options);
+
+    charset.save(file_name_prefix + "-charset.bin");
+
+    auto data = std::vector<uint8_t>();
+    data.reserve(indices.size() * 2);
+    for (auto index : indices) {
+        data.push_back(mapping[index] & 0xff);
+        if (charset_options.max_characters > 256) {
+            data.push_back(mapping[index] >> 8);
+        }
+    }
+    save_file(file_name_prefix + "-shifts.bin", data);
+    save_file(file_name_prefix + "-colors.bin", colors);
+}
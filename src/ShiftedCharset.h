@@ -0,0 +1,76 @@
+/*
+  ShiftedCharset.h -- charset of image shifted by 0-7 pixels
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_SHIFTED_CHARSET_H
+#define HAD_SHIFTED_CHARSET_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Charset.h"
+#include "ImageView.h"
+
+// Characters of image shifted left by 0-7 pixels, and optionally up by 0-7 rows, for soft scrolling.
+// Pixels shifted in from beyond the right or bottom edge of the image are background.
+// All cells share one background color, pixels combined into one shifted character must have the same foreground color.
+class ShiftedCharset {
+public:
+    Charset charset;
+
+    ShiftedCharset(const ImageView& image, uint8_t background_color, std::optional<uint8_t> foreground_color, bool vertical, const CharsetOptions& charset_options);
+
+    [[nodiscard]] size_t get_width() const { return width; }
+    [[nodiscard]] size_t get_height() const { return height; }
+    [[nodiscard]] size_t get_shift_count() const { return vertical ? 64 : 8; }
+
+    // Character with rows shifted left by x_shift pixels, filled from right, then shifted up by y_shift rows, filled from below.
+    static uint64_t shift(uint64_t tile, uint64_t right, uint64_t below, uint64_t below_right, size_t x_shift, size_t y_shift);
+
+    // Writes charset, screens and colors of all shifts, y shift major.
+    void save(const std::string& file_name_prefix);
+
+private:
+    size_t width;
+    size_t height;
+    bool vertical;
+    CharsetOptions charset_options;
+    // Character index for each shift and cell.
+    std::vector<size_t> indices;
+    // Foreground color for each shift and cell.
+    std::vector<uint8_t> colors;
+};
+
+#endif // HAD_SHIFTED_CHARSET_H
@@ -34,13 +34,17 @@
 
 #include "SpriteSheet.h"
 
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
 #include "Exception.h"
 #include "utils.h"
 
-SpriteSheet::SpriteSheet(size_t r, size_t c) : rows(r), columns(c), data(std::make_unique<unsigned char[]>(rows * columns * 64)) { }
+SpriteSheet::SpriteSheet(size_t r, size_t c) : rows(r), columns(c), data(rows * columns * 64) { }
 
-SpriteSheet::SpriteSheet(std::shared_ptr<Image> image, uint8_t background_color) : rows(image->get_height() / 21), columns(image->get_width() / 24), data(std::make_unique<unsigned char[]>(rows * columns * 64)) {
-    if (image->get_width() % 24 != 0 || image->get_height() % 21 != 0) {
+SpriteSheet::SpriteSheet(const ImageView& image, uint8_t background_color) : rows(image.get_height() / 21), columns(image.get_width() / 24), data(rows * columns * 64) {
+    if (image.get_width() % 24 != 0 || image.get_height() % 21 != 0) {
         throw Exception("image dimensions not multiple of sprite size");
     }
 
@@ -50,18 +54,50 @@ SpriteSheet::SpriteSheet(std::shared_ptr<Image> image, uint8_t background_color)
             std::optional<uint8_t> foreground_color;
 
             size_t offset = (sheet_y * columns + sheet_x) * 64;
-            for (size_t sprite_y = 0; sprite_y < 21; sprite_y++) {
-                for (size_t byte_x = 0; byte_x < 3; byte_x++) {
-                    auto byte = image->get_byte(sheet_x * 24 + byte_x * 8, sheet_y * 21 + sprite_y, bg_color, foreground_color);
-                    data[offset + sprite_y * 3 + byte_x] = byte;
-                }
+            auto status = image.encode_tile(sheet_x * 24, sheet_y * 21, 24, 21, bg_color, foreground_color, data.data() + offset);
+            if (!status.ok()) {
+                throw status.exception();
             }
-            
-            // TODO: store foreground color
+
+            data[offset + 63] = foreground_color.value_or(0);
         }
     }
 }
 
 void SpriteSheet::save(const std::string file_name) const {
-    save_file(file_name, data.get(), rows * columns * 64);
+    save_file(file_name, data.data(), data.size());
+}
+
+
+void SpriteSheet::save_deduplicated(const std::string& file_name, const std::string& index_file_name) const {
+    auto sprites = std::vector<uint8_t>();
+    auto indices = std::vector<uint8_t>();
+    auto sprite_index = std::unordered_map<std::string_view, uint8_t>();
+
+    for (size_t offset = 0; offset < data.size(); offset += 64) {
+        auto sprite = data.data() + offset;
+        if (std::all_of(sprite, sprite + 63, [](uint8_t byte) { return byte == 0; })) {
+            indices.push_back(empty_sprite);
+            continue;
+        }
+
+        // Sprites with same pixels but different colors are kept apart.
+        auto key = std::string_view(reinterpret_cast<const char *>(sprite), 64);
+        auto it = sprite_index.find(key);
+        if (it != sprite_index.end()) {
+            indices.push_back(it->second);
+            continue;
+        }
+
+        if (sprite_index.size() == empty_sprite) {
+            throw Exception("more than %d different sprites", empty_sprite);
+        }
+        auto index = static_cast<uint8_t>(sprite_index.size());
+        sprite_index[key] = index;
+        sprites.insert(sprites.end(), sprite, sprite + 64);
+        indices.push_back(index);
+    }
+
+    save_file(file_name, sprites);
+    save_file(index_file_name, indices);
 }
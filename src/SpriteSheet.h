@@ -37,24 +37,31 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
-#include "Image.h"
+#include "ImageView.h"
 
 class SpriteSheet {
 public:
+    // Index of empty cells in index table.
+    static constexpr uint8_t empty_sprite = 0xff;
+
     SpriteSheet(size_t rows, size_t columns);
-    SpriteSheet(std::shared_ptr<Image> image, uint8_t background_color);
+    SpriteSheet(const ImageView& image, uint8_t background_color);
     
     size_t get_rows() const { return rows; }
     size_t get_columns() const { return columns; }
     
+    // Each sprite is 63 bytes of pixels followed by its color.
     void save(const std::string file_name) const;
+    // Save only distinct non-empty sprites and index of sprite for each cell.
+    void save_deduplicated(const std::string& file_name, const std::string& index_file_name) const;
 
 private:
     size_t rows;
     size_t columns;
-    std::unique_ptr<uint8_t[]> data;
-
+    std::pmr::vector<uint8_t> data;
 };
 
 #endif // HAD_SPRITE_SHEET_H
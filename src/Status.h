@@ -0,0 +1,67 @@
+/*
+  Status.h -- result of conversion kernels
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_STATUS_H
+#define HAD_STATUS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Exception.h"
+
+// Cheap error result for inner loops; converted to an Exception at the API boundary.
+class Status {
+public:
+    enum Code {
+        OK,
+        CHARACTER_COLOR,
+        COLOR_CLASH,
+        INVALID_ALPHA,
+        INVALID_COLOR,
+        MIXED_BRIGHTNESS
+    };
+
+    Status() = default;
+    Status(Code code_, size_t x_, size_t y_, uint32_t value_ = 0) : code(code_), x(x_), y(y_), value(value_) { }
+
+    [[nodiscard]] bool ok() const { return code == OK; }
+    [[nodiscard]] Exception exception() const;
+
+    Code code{OK};
+    size_t x{};
+    size_t y{};
+    uint32_t value{};
+};
+
+#endif // HAD_STATUS_H
@@ -35,39 +35,91 @@
 #include "Exception.h"
 #include "TextScreen.h"
 
-TextScreen::TextScreen(size_t width, size_t height) : screen(width, height), colors(width, height) {
+#include <unordered_set>
+
+TextScreen::TextScreen(size_t width, size_t height) : screen(width, height), colors(width, height), transforms(width, height) {
 }
 
 
-TextScreen::TextScreen(std::shared_ptr<Image> image, uint8_t background_color) : screen(image->get_width() / 8, image->get_height() / 8), colors(image->get_width() / 8, image->get_height() / 8) {
-    if (image->get_width() % 8 != 0 || image->get_height() % 8 != 0) {
+TextScreen::TextScreen(const ImageView& image, uint8_t background_color, const CharsetOptions& charset_options) : charset(charset_options.reduce ? Charset::unlimited : charset_options.max_characters), screen(image.get_width() / 8, image.get_height() / 8), colors(image.get_width() / 8, image.get_height() / 8), transforms(image.get_width() / 8, image.get_height() / 8) {
+    if (image.get_width() % 8 != 0 || image.get_height() % 8 != 0) {
         throw Exception("image dimensions not multiple of 8");
     }
+    if (charset_options.max_characters > 256) {
+        throw Exception("text screen supports at most 256 characters");
+    }
     
+    charset.set_transforms(charset_options.transforms);
+
     auto bg_color = std::make_optional(background_color);
+    auto indices = std::vector<size_t>(get_width() * get_height());
     for (size_t screen_y = 0; screen_y < get_height(); screen_y++) {
         for (size_t screen_x = 0; screen_x < get_width(); screen_x++) {
             std::optional<uint8_t> foreground_color;
             uint8_t tile[8];
 
-            for (size_t tile_y = 0; tile_y < 8; tile_y++) {
-                auto tile_byte = image->get_byte(screen_x * 8, screen_y * 8 + tile_y, bg_color, foreground_color);
-                tile[tile_y] =  tile_byte;
+            auto status = image.encode_tile(screen_x * 8, screen_y * 8, 8, 8, bg_color, foreground_color, tile);
+            if (!status.ok()) {
+                throw status.exception();
             }
 
-            screen.set(screen_x, screen_y, charset.add(tile));
+            uint8_t transform;
+            indices[screen_y * get_width() + screen_x] = charset.add(tile, transform);
+            transforms.set(screen_x, screen_y, transform);
             if (foreground_color) {
                 colors.set(screen_x, screen_y, *foreground_color);
             }
         }
     }
+
+    auto mapping = charset.finish(charset_options);
+    for (auto& index : indices) {
+        index = mapping[index];
+    }
+
+    for (size_t screen_y = 0; screen_y < get_height(); screen_y++) {
+        for (size_t screen_x = 0; screen_x < get_width(); screen_x++) {
+            screen.set(screen_x, screen_y, indices[screen_y * get_width() + screen_x]);
+        }
+    }
+}
+
+
+uint8_t TextScreen::best_background(const ImageView& image, const Histogram& histogram) {
+    auto candidates = histogram.best_backgrounds();
+    if (candidates.empty()) {
+        return 0;
+    }
+
+    auto best = candidates[0];
+    size_t fewest_characters = SIZE_MAX;
+    for (auto candidate : candidates) {
+        auto characters = std::unordered_set<uint64_t>();
+        for (size_t y = 0; y < image.get_height() / 8; y++) {
+            for (size_t x = 0; x < image.get_width() / 8; x++) {
+                std::optional<uint8_t> bg_color = candidate;
+                std::optional<uint8_t> foreground_color;
+                uint64_t tile;
+                if (image.encode_tile(x * 8, y * 8, 8, 8, bg_color, foreground_color, reinterpret_cast<uint8_t *>(&tile)).ok()) {
+                    characters.insert(tile);
+                }
+            }
+        }
+        if (characters.size() < fewest_characters) {
+            fewest_characters = characters.size();
+            best = candidate;
+        }
+    }
+
+    return best;
 }
 
 
 void TextScreen::set(size_t x, size_t y, const uint8_t tile[], uint8_t color) {
-    screen.set(x, y, charset.add(tile));
+    uint8_t transform;
+    screen.set(x, y, charset.add(tile, transform));
     colors.set(x, y, color);
-    
+    transforms.set(x, y, transform);
 }
 
 
@@ -75,5 +127,8 @@ void TextScreen::save(const std::string file_name_prefix, bool full) {
     charset.save(file_name_prefix + "-charset.bin", full);
     screen.save(file_name_prefix + "-screen.bin");
     colors.save(file_name_prefix + "-colors.bin");
+    if (charset.get_transforms() != 0) {
+        transforms.save(file_name_prefix + "-transforms.bin");
+    }
 }
 
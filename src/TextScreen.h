@@ -39,7 +39,8 @@
 #include <memory>
 
 #include "Charset.h"
-#include "Image.h"
+#include "Histogram.h"
+#include "ImageView.h"
 #include "Matrix.h"
 
 class TextScreen {
@@ -47,9 +48,14 @@ public:
     Charset charset;
     Matrix screen;
     Matrix colors;
+    // Charset transforms to apply to characters, only saved if charset allows transforms.
+    Matrix transforms;
     
     TextScreen(size_t width, size_t height);
-    TextScreen(std::shared_ptr<Image> image, uint8_t background_color);
+    TextScreen(const ImageView& image, uint8_t background_color, const CharsetOptions& charset_options = {});
+
+    // Background color with fewest color clashes that needs the fewest characters.
+    static uint8_t best_background(const ImageView& image, const Histogram& histogram);
     
     size_t get_width() const { return screen.get_width(); }
     size_t get_height() const { return screen.get_height(); }
@@ -0,0 +1,107 @@
+/*
+  TileIndex.cc -- hash index of 8x8 tiles
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "TileIndex.h"
+
+#include <algorithm>
+
+static constexpr size_t initial_slots = 1024;
+
+TileIndex::TileIndex() : tiles(initial_slots), values(initial_slots, empty), count(0) {
+}
+
+
+std::optional<uint32_t> TileIndex::find(uint64_t tile) const {
+    auto slot = slot_for(tile);
+    if (values[slot] == empty) {
+        return {};
+    }
+    return values[slot];
+}
+
+
+bool TileIndex::insert(uint64_t tile, uint32_t value) {
+    // Keep load factor at most 1/2 so probe sequences stay short.
+    if ((count + 1) * 2 > values.size()) {
+        grow();
+    }
+
+    auto slot = slot_for(tile);
+    if (values[slot] != empty) {
+        return false;
+    }
+    tiles[slot] = tile;
+    values[slot] = value;
+    count++;
+    return true;
+}
+
+
+void TileIndex::clear() {
+    std::fill(values.begin(), values.end(), empty);
+    count = 0;
+}
+
+
+// Slot containing tile, or the empty slot where it would be inserted.
+size_t TileIndex::slot_for(uint64_t tile) const {
+    // Mix bits, since tiles often differ only in a few bytes.
+    auto hash = tile;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    auto mask = values.size() - 1;
+    auto slot = hash & mask;
+    while (values[slot] != empty && tiles[slot] != tile) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+
+void TileIndex::grow() {
+    auto old_tiles = std::move(tiles);
+    auto old_values = std::move(values);
+    tiles.assign(old_tiles.size() * 2, 0);
+    values.assign(old_values.size() * 2, empty);
+
+    for (size_t slot = 0; slot < old_values.size(); slot++) {
+        if (old_values[slot] != empty) {
+            auto new_slot = slot_for(old_tiles[slot]);
+            tiles[new_slot] = old_tiles[slot];
+            values[new_slot] = old_values[slot];
+        }
+    }
+}
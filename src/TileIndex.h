@@ -0,0 +1,75 @@
+/*
+  TileIndex.h -- hash index of 8x8 tiles
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_TILE_INDEX_H
+#define HAD_TILE_INDEX_H
+
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+// Maps 64 bit tiles to 32 bit values, using open addressing in flat arrays so adding tiles doesn't allocate per tile.
+class TileIndex {
+public:
+    TileIndex();
+
+    [[nodiscard]] size_t size() const { return count; }
+
+    [[nodiscard]] std::optional<uint32_t> find(uint64_t tile) const;
+    // Returns false if tile is already in index, leaving its value unchanged.
+    bool insert(uint64_t tile, uint32_t value);
+    void clear();
+
+    // Replace each value with function(value).
+    template <typename Function> void update_values(Function function) {
+        for (size_t slot = 0; slot < values.size(); slot++) {
+            if (values[slot] != empty) {
+                values[slot] = function(values[slot]);
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t empty = UINT32_MAX;
+
+    std::pmr::vector<uint64_t> tiles;
+    std::pmr::vector<uint32_t> values;
+    size_t count;
+
+    [[nodiscard]] size_t slot_for(uint64_t tile) const;
+    void grow();
+};
+
+#endif // HAD_TILE_INDEX_H
@@ -0,0 +1,230 @@
+/*
+  Validator.cc -- check image for all conversion problems
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "Validator.h"
+
+#include <bitset>
+#include <unordered_set>
+
+#include "CellIndex.h"
+#include "Exception.h"
+#include "utils.h"
+
+std::string Validator::Problem::message() const {
+    switch (type) {
+        case COLOR_CLASH: {
+            auto text = string_format("color clash in cell at (%zu, %zu): colors", x, y);
+            for (size_t i = 0; i < colors.size(); i++) {
+                text += string_format("%s %u", i == 0 ? "" : ",", colors[i]);
+            }
+            return text;
+        }
+
+        case MIXED_BRIGHTNESS:
+            return string_format("mixing dark and bright colors %u and %u in cell at (%zu, %zu)", colors[0], colors[1], x, y);
+
+        case OUT_OF_CHARACTERS:
+            return string_format("out of characters in cell at (%zu, %zu): %zu characters needed, %zu available", x, y, characters_needed, characters_available);
+    }
+
+    return "";
+}
+
+
+Validator::Validator(const ImageView& image, size_t cell_width, size_t cell_height) : image(image), cell_width(cell_width), cell_height(cell_height), columns(image.get_width() / cell_width), rows(image.get_height() / cell_height) {
+    if (image.get_width() % cell_width != 0 || image.get_height() % cell_height != 0) {
+        throw Exception("image dimensions not multiple of cell size");
+    }
+    compute_color_sets();
+}
+
+
+void Validator::check_colors(std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color, size_t colors_per_cell) {
+    ColorSet fixed{};
+    fixed[image.get_image()->get_palette()->transparent_index / 64] |= uint64_t{1} << (image.get_image()->get_palette()->transparent_index % 64);
+    auto available = colors_per_cell;
+    for (const auto& color : {background_color, foreground_color}) {
+        if (color) {
+            fixed[*color / 64] |= uint64_t{1} << (*color % 64);
+            available -= 1;
+        }
+    }
+
+    for (size_t index = 0; index < color_sets.size(); index++) {
+        size_t count = 0;
+        for (size_t word = 0; word < 4; word++) {
+            count += std::bitset<64>(color_sets[index][word] & ~fixed[word]).count();
+        }
+        if (count > available) {
+            problems.emplace_back(Problem::COLOR_CLASH, image.get_x_offset() + (index % columns) * cell_width, image.get_y_offset() + (index / columns) * cell_height, cell_colors(index, {}, {}));
+        }
+    }
+}
+
+
+void Validator::check_brightness(std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color) {
+    for (size_t index = 0; index < color_sets.size(); index++) {
+        auto colors = cell_colors(index, background_color, foreground_color);
+        if (colors.size() > 2) {
+            continue;
+        }
+        // Unused colors are encoded as 0, like in Bitmap.
+        colors.resize(2, 0);
+        if ((colors[0] & 0x8) != (colors[1] & 0x8) && colors[0] != 0 && colors[1] != 0) {
+            problems.emplace_back(Problem::MIXED_BRIGHTNESS, image.get_x_offset() + (index % columns) * cell_width, image.get_y_offset() + (index / columns) * cell_height, colors);
+        }
+    }
+}
+
+
+void Validator::check_charset(Charset& charset, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color) {
+    check_charset(charset, [&](size_t x, size_t y, uint8_t *tile) {
+        auto bg_color = background_color;
+        auto fg_color = foreground_color;
+        return image.encode_tile(x, y, cell_width, cell_height, bg_color, fg_color, tile).ok();
+    });
+}
+
+
+void Validator::check_multicolor_charset(Charset& charset, const std::array<uint8_t, 3>& shared_colors) {
+    check_charset(charset, [&](size_t x, size_t y, uint8_t *tile) {
+        std::optional<uint8_t> cell_colors[3] = {shared_colors[1], shared_colors[2], {}};
+        return image.encode_multicolor_tile(x, y, cell_width, cell_height, shared_colors[0], cell_colors, tile).ok();
+    });
+}
+
+
+void Validator::check_charset(Charset& charset, const std::function<bool(size_t x, size_t y, uint8_t *tile)>& encode) {
+    // Large enough for hires and multicolor tiles.
+    auto tile = std::vector<uint8_t>(cell_width * cell_height / 4);
+    auto missing = std::unordered_set<uint64_t>();
+    std::optional<Problem> overflow;
+
+    for (size_t index = 0; index < color_sets.size(); index++) {
+        auto x = (index % columns) * cell_width;
+        auto y = (index / columns) * cell_height;
+        if (!encode(x, y, tile.data())) {
+            continue;
+        }
+
+        if (charset.find(tile.data())) {
+            continue;
+        }
+        if (charset.get_size() < charset.get_max_chars()) {
+            charset.add(tile.data());
+            continue;
+        }
+        if (!overflow) {
+            overflow = Problem(Problem::OUT_OF_CHARACTERS, image.get_x_offset() + x, image.get_y_offset() + y);
+        }
+        missing.insert(*reinterpret_cast<const uint64_t *>(tile.data()));
+    }
+
+    if (overflow) {
+        overflow->characters_needed = charset.get_size() + missing.size();
+        overflow->characters_available = charset.get_max_chars();
+        problems.push_back(*overflow);
+    }
+}
+
+
+void Validator::compute_color_sets() {
+    color_sets.resize(columns * rows);
+
+    if (image.get_x_offset() % cell_width == 0 && image.get_y_offset() % cell_height == 0) {
+        auto cell_index = image.get_image()->get_cell_index(cell_width, cell_height);
+        if (cell_index) {
+            auto transparent_index = image.get_image()->get_palette()->transparent_index;
+            for (size_t cell_y = 0; cell_y < rows; cell_y++) {
+                for (size_t cell_x = 0; cell_x < columns; cell_x++) {
+                    const auto& cell = cell_index->get(image.get_x_offset() / cell_width + cell_x, image.get_y_offset() / cell_height + cell_y);
+                    auto& set = color_sets[cell_y * columns + cell_x];
+                    set[0] = cell.colors;
+                    if (cell.has_transparency) {
+                        set[transparent_index / 64] |= uint64_t{1} << (transparent_index % 64);
+                    }
+                }
+            }
+            return;
+        }
+    }
+
+    parallel_for(rows, [&](size_t begin, size_t end) {
+        auto row = std::vector<uint8_t>(image.get_width());
+
+        for (size_t cell_y = begin; cell_y < end; cell_y++) {
+            auto sets = color_sets.data() + cell_y * columns;
+            for (size_t y = 0; y < cell_height; y++) {
+                image.get_row(cell_y * cell_height + y, row.data());
+
+                for (size_t cell_x = 0; cell_x < columns; cell_x++) {
+                    auto pixels = row.data() + cell_x * cell_width;
+                    // Branch free, so the compiler can vectorize the reduction.
+                    uint64_t words[4] = {0, 0, 0, 0};
+                    for (size_t x = 0; x < cell_width; x++) {
+                        auto bit = uint64_t{1} << (pixels[x] % 64);
+                        auto word = pixels[x] / 64;
+                        words[0] |= word == 0 ? bit : 0;
+                        words[1] |= word == 1 ? bit : 0;
+                        words[2] |= word == 2 ? bit : 0;
+                        words[3] |= word == 3 ? bit : 0;
+                    }
+                    for (size_t word = 0; word < 4; word++) {
+                        sets[cell_x][word] |= words[word];
+                    }
+                }
+            }
+        }
+    });
+}
+
+
+// Colors of cell in the order Image::get_tile() assigns them: fixed colors first, then the others by index, omitting transparency.
+std::vector<uint8_t> Validator::cell_colors(size_t index, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color) const {
+    auto colors = std::vector<uint8_t>();
+    auto transparent_index = image.get_image()->get_palette()->transparent_index;
+
+    for (const auto& color : {background_color, foreground_color}) {
+        if (color) {
+            colors.push_back(*color);
+        }
+    }
+    for (size_t color = 0; color < 256; color++) {
+        if ((color_sets[index][color / 64] & (uint64_t{1} << (color % 64))) && color != transparent_index && color != background_color && color != foreground_color) {
+            colors.push_back(static_cast<uint8_t>(color));
+        }
+    }
+
+    return colors;
+}
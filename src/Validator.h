@@ -0,0 +1,104 @@
+/*
+  Validator.h -- check image for all conversion problems
+  Copyright (C) 2026 Dieter Baron
+
+  This file is part of gfx-convert, a graphics converter toolbox
+  for 8-bit systems.
+  The authors can be contacted at <gfx-convert@tpau.group>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HAD_VALIDATOR_H
+#define HAD_VALIDATOR_H
+
+#include <array>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Charset.h"
+#include "ImageView.h"
+
+class Validator {
+public:
+    class Problem {
+    public:
+        enum Type {
+            COLOR_CLASH,
+            MIXED_BRIGHTNESS,
+            OUT_OF_CHARACTERS
+        };
+
+        Problem(Type type_, size_t x_, size_t y_, std::vector<uint8_t> colors_ = {}) : type(type_), x(x_), y(y_), colors(std::move(colors_)) { }
+
+        [[nodiscard]] std::string message() const;
+
+        Type type;
+        // Position of cell in image.
+        size_t x;
+        size_t y;
+        std::vector<uint8_t> colors;
+        // For OUT_OF_CHARACTERS.
+        size_t characters_needed{};
+        size_t characters_available{};
+    };
+
+    Validator(const ImageView& image, size_t cell_width, size_t cell_height);
+
+    // Report cells with more colors than fit alongside the given fixed colors.
+    void check_colors(std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color, size_t colors_per_cell = 2);
+    // Report cells mixing bright and dark Spectrum colors.
+    void check_brightness(std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color);
+    // Add cells to charset, reporting the first cell that doesn't fit and the number of characters needed.
+    // Cells with color clashes are skipped, check_colors() reports them.
+    void check_charset(Charset& charset, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color);
+    // Same for multicolor characters using background and shared multicolors.
+    void check_multicolor_charset(Charset& charset, const std::array<uint8_t, 3>& shared_colors);
+
+    [[nodiscard]] const std::vector<Problem>& get_problems() const { return problems; }
+
+private:
+    // Set of palette indices used in a cell, bit i of word i / 64 for index i.
+    typedef std::array<uint64_t, 4> ColorSet;
+
+    void compute_color_sets();
+    // encode(x, y, tile) returns false for cells that can't be encoded.
+    void check_charset(Charset& charset, const std::function<bool(size_t x, size_t y, uint8_t *tile)>& encode);
+    [[nodiscard]] std::vector<uint8_t> cell_colors(size_t index, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color) const;
+
+    ImageView image;
+    size_t cell_width;
+    size_t cell_height;
+    size_t columns;
+    size_t rows;
+
+    std::vector<ColorSet> color_sets;
+    std::vector<Problem> problems;
+};
+
+#endif // HAD_VALIDATOR_H
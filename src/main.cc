@@ -30,26 +30,43 @@
 
 #include <iostream>
 
+#include "Arena.h"
 #include "Bitmap.h"
+#include "ColorReducer.h"
 #include "Commandline.h"
 #include "Exception.h"
+#include "FrameSequence.h"
+#include "Histogram.h"
+#include "MetatileMap.h"
+#include "MulticolorBitmap.h"
+#include "MulticolorTextScreen.h"
 #include "read.h"
 #include "write_png.h"
 #include "Noter.h"
+#include "PaletteRegistry.h"
+#include "PetsciiScreen.h"
 #include "TextScreen.h"
+#include "ShiftedCharset.h"
 #include "SpriteSheet.h"
 #include "utils.h"
+#include "Validator.h"
 
 #include <filesystem>
 
 enum Format {
     FORMAT_BITMAP,
     FORMAT_CHARSET,
+    FORMAT_MAP,
+    FORMAT_MULTICOLOR_BITMAP,
+    FORMAT_MULTICOLOR_CHARSET,
     FORMAT_NOTER,
+    FORMAT_PETSCII,
     FORMAT_PRINTFOX,
     FORMAT_RAW,
     FORMAT_RAW_CHARSET,
     FORMAT_SCREEN,
+    FORMAT_SEQUENCE,
+    FORMAT_SHIFTED_CHARSET,
     FORMAT_SPECTRUM,
     FORMAT_SPRITES,
     FORMAT_TEXT
@@ -58,19 +75,43 @@ enum Format {
 std::unordered_map<std::string, Format> format_name = {
         {"bitmap", FORMAT_BITMAP},
         {"charset", FORMAT_CHARSET},
+        {"map", FORMAT_MAP},
+        {"multicolor-bitmap", FORMAT_MULTICOLOR_BITMAP},
+        {"multicolor-charset", FORMAT_MULTICOLOR_CHARSET},
         {"noter", FORMAT_NOTER},
+        {"petscii", FORMAT_PETSCII},
         {"printfox", FORMAT_PRINTFOX},
         {"raw", FORMAT_RAW},
         {"raw-charset", FORMAT_RAW_CHARSET},
         {"screen", FORMAT_SCREEN},
+        {"sequence", FORMAT_SEQUENCE},
+        {"shifted-charset", FORMAT_SHIFTED_CHARSET},
         {"spectrum", FORMAT_SPECTRUM},
         {"sprites", FORMAT_SPRITES},
         {"text", FORMAT_TEXT}
 };
 
 std::vector<Commandline::Option> options = {
-        Commandline::Option("background", 'b', "index", "specify index of background color , or 'transparent'"),
-        Commandline::Option("output-directory", 'd', "directory", "specify directory to write files to")
+        Commandline::Option("background", 'b', "index", "specify index of background color, 'transparent', or 'auto'"),
+        Commandline::Option("charset", "file", "use characters from charset file for petscii format"),
+        Commandline::Option("charset-banks", "split screens into several charsets in order if they need more characters than available"),
+        Commandline::Option("check", "report all problems converting image instead of converting it"),
+        Commandline::Option("compress", "compress output files in LZ4 block format"),
+        Commandline::Option("deduplicate-sprites", "write only distinct non-empty sprites and an index table of sprite per cell"),
+        Commandline::Option("dither", "method", "dither colors not in palette: ordered, floyd-steinberg, or atkinson"),
+        Commandline::Option("keyframe-interval", "frames", "store every n-th frame of sequence format completely (default only first)"),
+        Commandline::Option("max-characters", "count", "number of characters available (up to 65536), screen format writes 16 bit indices if more than 256"),
+        Commandline::Option("metatile-size", "size", "number of characters per side of metatiles for map format (default 2)"),
+        Commandline::Option("nearest-color", 'n', "map colors not in palette to closest palette color"),
+        Commandline::Option("output-directory", 'd', "directory", "specify directory to write files to"),
+        Commandline::Option("palette", 'p', "palette", "use palette: c64-colodore, zx-spectrum, or name of .gpl, .act, or hex palette file"),
+        Commandline::Option("sort-charset", "order characters by how often they are used, most used first"),
+        Commandline::Option("source-palette", "palette", "decode image colors with variant of palette, or 'auto' to detect"),
+        Commandline::Option("reduce-charset", "merge most similar characters if more are needed than available"),
+        Commandline::Option("reduce-colors", "fix color clashes by reducing cells to the colors closest to the original"),
+        Commandline::Option("region", 'r', "x,y,width,height", "only convert given region of image, may be given multiple times"),
+        Commandline::Option("transforms", "list", "reuse characters for mirrored (x), flipped (y), or inverse (i) tiles, writes transforms file"),
+        Commandline::Option("vertical-shifts", "also shift characters up by 0-7 rows for shifted-charset format")
 };
 
 std::filesystem::path make_output_filename(const std::filesystem::path& directory, const std::filesystem::path& filename) {
@@ -80,6 +121,261 @@ std::filesystem::path make_output_filename(const std::filesystem::path& director
     return std::filesystem::path(directory) / filename.filename();
 }
 
+// Screen of screen format, saved once the charset shared by all screens is final.
+class PendingScreen {
+public:
+    std::filesystem::path file_name;
+    std::vector<size_t> indices;
+    std::vector<uint8_t> transforms;
+};
+
+// Insert region number before extension: foo.bin -> foo-1.bin
+std::filesystem::path make_region_filename(const std::filesystem::path& filename, size_t region_index) {
+    auto name = filename;
+    name.replace_filename(filename.stem().string() + "-" + std::to_string(region_index + 1) + filename.extension().string());
+    return name;
+}
+
+void convert(Format format, const ImageView& image, const std::filesystem::path& file_name, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color, const CharsetOptions& charset_options, bool vertical_shifts, bool deduplicate_sprites, const std::vector<uint8_t>& fixed_charset) {
+    switch (format) {
+        case FORMAT_TEXT: {
+            auto text_screen = TextScreen(image, background_color.value_or(0), charset_options);
+            text_screen.save(file_name);
+            break;
+        }
+            
+        case FORMAT_SPRITES: {
+            auto sprites = SpriteSheet(image, 254);
+            if (deduplicate_sprites) {
+                auto index_file_name = file_name;
+                index_file_name.replace_filename(file_name.stem().string() + "-index" + file_name.extension().string());
+                sprites.save_deduplicated(file_name, index_file_name);
+            }
+            else {
+                sprites.save(file_name);
+            }
+            break;
+        }
+            
+        case FORMAT_CHARSET: {
+            auto bitmap = Bitmap(image, Bitmap::C64, background_color, foreground_color);
+            save_file(file_name, bitmap.bitmap.data(), bitmap.bitmap.size());
+            break;
+        }
+
+        case FORMAT_SHIFTED_CHARSET: {
+            auto shifted_charset = ShiftedCharset(image, background_color.value_or(0), foreground_color, vertical_shifts, charset_options);
+            shifted_charset.save(file_name);
+            break;
+        }
+            
+        case FORMAT_BITMAP: {
+            auto bitmap = Bitmap(image, Bitmap::C64, background_color, foreground_color);
+            bitmap.save(file_name);
+            break;
+        }
+            
+        case FORMAT_RAW:
+        case FORMAT_RAW_CHARSET:
+        case FORMAT_PRINTFOX: {
+            image_write_png(file_name, image);
+            break;
+        }
+            
+        case FORMAT_MULTICOLOR_BITMAP: {
+            auto bitmap = MulticolorBitmap(image, background_color);
+            bitmap.save(file_name);
+            break;
+        }
+
+        case FORMAT_MULTICOLOR_CHARSET: {
+            auto text_screen = MulticolorTextScreen(image, background_color, charset_options);
+            text_screen.save(file_name);
+            break;
+        }
+
+        case FORMAT_PETSCII: {
+            auto text_screen = PetsciiScreen(image, fixed_charset, background_color.value_or(0));
+            text_screen.save(file_name);
+            break;
+        }
+
+        case FORMAT_NOTER: {
+            auto bitmap = Noter(image, background_color, foreground_color);
+            bitmap.save(file_name);
+            break;
+        }
+        
+        case FORMAT_SPECTRUM: {
+            auto bitmap = Bitmap(image, Bitmap::SPECTRUM, background_color, foreground_color);
+            save_file(file_name, bitmap.bitmap.data(), bitmap.bitmap.size());
+            break;
+        }
+
+        case FORMAT_MAP:
+        case FORMAT_SCREEN:
+        case FORMAT_SEQUENCE:
+            break;
+    }
+}
+
+// Choose background color that causes the fewest color clashes.
+std::optional<uint8_t> best_background(Format format, const ImageView& image) {
+    switch (format) {
+        case FORMAT_SEQUENCE:
+        case FORMAT_TEXT:
+            return TextScreen::best_background(image, Histogram(image, 8, 8));
+
+        case FORMAT_BITMAP:
+        case FORMAT_CHARSET:
+        case FORMAT_MAP:
+        case FORMAT_PETSCII:
+        case FORMAT_SCREEN:
+        case FORMAT_SHIFTED_CHARSET:
+        case FORMAT_SPECTRUM:
+        case FORMAT_NOTER: {
+            auto histogram = format == FORMAT_NOTER ? Histogram(image, 8, 16) : Histogram(image, 8, 8);
+            auto candidates = histogram.best_backgrounds();
+            if (candidates.empty()) {
+                return {};
+            }
+            return candidates[0];
+        }
+
+        case FORMAT_MULTICOLOR_BITMAP:
+            return MulticolorBitmap::best_background(Histogram(image, 4, 8));
+
+        case FORMAT_MULTICOLOR_CHARSET:
+            return MulticolorTextScreen::best_shared_colors(Histogram(image, 4, 8), {})[0];
+
+        case FORMAT_SPRITES:
+        case FORMAT_RAW:
+        case FORMAT_RAW_CHARSET:
+        case FORMAT_PRINTFOX:
+            return {};
+    }
+
+    return {};
+}
+
+// Reduce cells of image to colors format can represent.
+void reduce_colors(Format format, const ImageView& image, std::optional<uint8_t> background_color) {
+    switch (format) {
+        case FORMAT_SEQUENCE:
+        case FORMAT_TEXT:
+            ColorReducer(8, 8, background_color.value_or(0)).reduce(image);
+            break;
+
+        case FORMAT_SPRITES:
+            ColorReducer(24, 21, 254).reduce(image);
+            break;
+
+        case FORMAT_BITMAP:
+        case FORMAT_CHARSET:
+        case FORMAT_MAP:
+        case FORMAT_SCREEN:
+        case FORMAT_SHIFTED_CHARSET:
+            ColorReducer(8, 8, background_color).reduce(image);
+            break;
+
+        case FORMAT_NOTER:
+            ColorReducer(8, 16, background_color).reduce(image);
+            break;
+
+        case FORMAT_MULTICOLOR_BITMAP:
+            ColorReducer(4, 8, background_color, false, 4).reduce(image);
+            break;
+
+        case FORMAT_MULTICOLOR_CHARSET: {
+            auto histogram = Histogram(image, 4, 8);
+            auto shared_colors = MulticolorTextScreen::best_shared_colors(histogram, background_color);
+            auto reducer = ColorReducer(4, 8, shared_colors[0], false, 4);
+            // Character colors come from color RAM, where bit 3 selects multicolor mode.
+            reducer.set_shared_colors({shared_colors[1], shared_colors[2]}, 8);
+            reducer.reduce(image, histogram);
+            break;
+        }
+
+        case FORMAT_SPECTRUM:
+            ColorReducer(8, 8, background_color, true).reduce(image);
+            break;
+
+        case FORMAT_PETSCII:
+            // Cells are approximated by closest character anyway.
+        case FORMAT_RAW:
+        case FORMAT_RAW_CHARSET:
+        case FORMAT_PRINTFOX:
+            break;
+    }
+}
+
+// Report all problems converting image to stderr, returns number of problems found.
+size_t check(Format format, const ImageView& image, const std::string& file_name, Charset& charset, std::optional<uint8_t> background_color, std::optional<uint8_t> foreground_color) {
+    std::optional<Validator> validator;
+
+    switch (format) {
+        case FORMAT_TEXT:
+            validator.emplace(image, 8, 8);
+            validator->check_colors(background_color.value_or(0), {});
+            validator->check_charset(charset, background_color.value_or(0), {});
+            break;
+
+        case FORMAT_SPRITES:
+            validator.emplace(image, 24, 21);
+            validator->check_colors(254, {});
+            break;
+
+        case FORMAT_BITMAP:
+        case FORMAT_CHARSET:
+        case FORMAT_SHIFTED_CHARSET:
+            validator.emplace(image, 8, 8);
+            validator->check_colors(background_color, foreground_color);
+            break;
+
+        case FORMAT_NOTER:
+            validator.emplace(image, 8, 16);
+            validator->check_colors(background_color, foreground_color);
+            break;
+
+        case FORMAT_MULTICOLOR_BITMAP:
+            validator.emplace(image, 4, 8);
+            validator->check_colors(background_color, {}, 4);
+            break;
+
+        case FORMAT_MULTICOLOR_CHARSET:
+            validator.emplace(image, 4, 8);
+            validator->check_colors(background_color, {}, 4);
+            validator->check_multicolor_charset(charset, MulticolorTextScreen::best_shared_colors(Histogram(image, 4, 8), background_color));
+            break;
+
+        case FORMAT_SPECTRUM:
+            validator.emplace(image, 8, 8);
+            validator->check_colors(background_color, foreground_color);
+            validator->check_brightness(background_color, foreground_color);
+            break;
+
+        case FORMAT_SCREEN:
+            validator.emplace(image, 8, 8);
+            validator->check_colors(background_color, foreground_color);
+            validator->check_charset(charset, background_color, foreground_color);
+            break;
+
+        case FORMAT_MAP:
+        case FORMAT_SEQUENCE:
+            // Checked while converting, since the whole image is not available at once.
+        case FORMAT_PETSCII:
+        case FORMAT_RAW:
+        case FORMAT_RAW_CHARSET:
+        case FORMAT_PRINTFOX:
+            return 0;
+    }
+
+    for (const auto& problem : validator->get_problems()) {
+        std::cerr << file_name << ": " << problem.message() << "\n";
+    }
+    return validator->get_problems().size();
+}
+
 int main(int argc, char **argv) {
     auto commandline = Commandline(options, "format image filename-prefix", "gfx-converter by Dieter Baron",
     "Report bugs to <gfx-converter@tpau.group>.",
@@ -92,6 +388,8 @@ int main(int argc, char **argv) {
         exit(1);
     }
     
+    size_t problems = 0;
+
     try {
         Format format;
 
@@ -103,33 +401,180 @@ int main(int argc, char **argv) {
             throw Exception("unknown format '%s'", arguments.arguments[0].c_str());
         }
 
+        Arena arena;
+        auto check_only = false;
+        auto reduce = false;
+        CharsetOptions charset_options;
+        auto charset_banks = false;
+        size_t metatile_size = 2;
+        auto vertical_shifts = false;
+        auto deduplicate_sprites = false;
+        size_t keyframe_interval = 0;
+        std::vector<uint8_t> fixed_charset;
+        std::string source_palette_name;
+        auto auto_background = false;
         std::shared_ptr<Image> image;
         std::optional<uint8_t> background_color;
         std::optional<uint8_t> foreground_color;
         std::filesystem::path output_directory{};
+        std::vector<ImageView::Region> regions;
+        std::shared_ptr<const Palette> palette;
+        ReadOptions read_options;
 
         for (const auto& option : arguments.options) {
             if (option.name == "background") {
+                auto_background = false;
                 if (option.argument == "transparent") {
                     background_color = 255;
                 }
+                else if (option.argument == "auto") {
+                    auto_background = true;
+                    background_color = {};
+                }
                 else {
                     // TODO: error handling
                     background_color = atoi(option.argument.c_str());
                 }
             }
+            else if (option.name == "charset-banks") {
+                charset_banks = true;
+            }
+            else if (option.name == "charset") {
+                fixed_charset = load_file(option.argument);
+                if (option.argument.size() > 4 && option.argument.substr(option.argument.size() - 4) == ".prg" && fixed_charset.size() >= 2) {
+                    // skip load address
+                    fixed_charset.erase(fixed_charset.begin(), fixed_charset.begin() + 2);
+                }
+            }
+            else if (option.name == "check") {
+                check_only = true;
+            }
+            else if (option.name == "compress") {
+                set_compress_files(true);
+            }
+            else if (option.name == "deduplicate-sprites") {
+                deduplicate_sprites = true;
+            }
+            else if (option.name == "dither") {
+                read_options.dither = Dither::method(option.argument);
+            }
+            else if (option.name == "keyframe-interval") {
+                char *end;
+                keyframe_interval = strtoul(option.argument.c_str(), &end, 10);
+                if (*end != '\0' || keyframe_interval == 0 || keyframe_interval > 65535) {
+                    throw Exception("invalid keyframe interval '%s'", option.argument.c_str());
+                }
+            }
+            else if (option.name == "max-characters") {
+                char *end;
+                charset_options.max_characters = strtoul(option.argument.c_str(), &end, 10);
+                if (*end != '\0' || charset_options.max_characters == 0 || charset_options.max_characters > 65536) {
+                    throw Exception("invalid number of characters '%s'", option.argument.c_str());
+                }
+            }
+            else if (option.name == "metatile-size") {
+                char *end;
+                metatile_size = strtoul(option.argument.c_str(), &end, 10);
+                if (*end != '\0' || metatile_size == 0 || metatile_size > 16) {
+                    throw Exception("invalid metatile size '%s'", option.argument.c_str());
+                }
+            }
+            else if (option.name == "nearest-color") {
+                read_options.nearest_color = true;
+            }
             else if (option.name == "output-directory") {
                 output_directory = std::filesystem::path(option.argument);
             }
+            else if (option.name == "palette") {
+                palette = PaletteRegistry::get(option.argument);
+            }
+            else if (option.name == "sort-charset") {
+                charset_options.sort_by_usage = true;
+            }
+            else if (option.name == "source-palette") {
+                if (option.argument == "auto") {
+                    read_options.detect_source_palette = true;
+                }
+                else {
+                    read_options.source_palette = PaletteRegistry::get(option.argument);
+                    source_palette_name = option.argument;
+                }
+            }
+            else if (option.name == "reduce-charset") {
+                charset_options.reduce = true;
+            }
+            else if (option.name == "reduce-colors") {
+                reduce = true;
+            }
+            else if (option.name == "vertical-shifts") {
+                vertical_shifts = true;
+            }
+            else if (option.name == "region") {
+                regions.emplace_back(option.argument);
+            }
+            else if (option.name == "transforms") {
+                charset_options.transforms = Charset::transforms(option.argument);
+            }
+        }
+
+        switch (format) {
+            case FORMAT_BITMAP:
+            case FORMAT_CHARSET:
+            case FORMAT_MAP:
+            case FORMAT_PETSCII:
+            case FORMAT_SCREEN:
+            case FORMAT_SEQUENCE:
+            case FORMAT_SHIFTED_CHARSET:
+            case FORMAT_SPECTRUM:
+            case FORMAT_TEXT:
+                read_options.tile_width = 8;
+                read_options.tile_height = 8;
+                break;
+
+            case FORMAT_MULTICOLOR_BITMAP:
+            case FORMAT_MULTICOLOR_CHARSET:
+                read_options.tile_width = 4;
+                read_options.tile_height = 8;
+                // Multicolor modes always need a background color.
+                if (!background_color) {
+                    auto_background = true;
+                }
+                break;
+
+            case FORMAT_NOTER:
+                read_options.tile_width = 8;
+                read_options.tile_height = 16;
+                break;
+
+            case FORMAT_SPRITES:
+                read_options.tile_width = 24;
+                read_options.tile_height = 21;
+                break;
+
+            default:
+                break;
+        }
+
+        if (format == FORMAT_PETSCII && fixed_charset.empty()) {
+            throw Exception("petscii format needs charset, use --charset");
+        }
+
+        if (!palette) {
+            palette = format == FORMAT_SPECTRUM ? PaletteRegistry::zx_spectrum() : PaletteRegistry::c64_colodore();
+        }
+
+        // Indices decoded with the source palette are used as is, so its entries must correspond to the palette's.
+        if (read_options.source_palette && read_options.source_palette->size() != palette->size()) {
+            throw Exception("source palette '%s' has %zu colors, palette has %zu", source_palette_name.c_str(), read_options.source_palette->size(), palette->size());
         }
 
         switch (format) {
         case FORMAT_PRINTFOX:
-            image = image_read_printfox(arguments.arguments[1], std::make_shared<Palette>(Palette::c64_colodore));
+            image = image_read_printfox(arguments.arguments[1], palette);
             break;
             
         case FORMAT_RAW:
-            image = image_read_raw(arguments.arguments[1], std::make_shared<Palette>(Palette::c64_colodore), 384, 272);
+            image = image_read_raw(arguments.arguments[1], palette, 384, 272);
             break;
 
         case FORMAT_RAW_CHARSET:
@@ -137,100 +582,222 @@ int main(int argc, char **argv) {
             break;
 
         case FORMAT_SPECTRUM:
-            image = image_read_png(arguments.arguments[1], std::make_shared<Palette>(Palette::zx_spectrum));
+            image = image_read_png(arguments.arguments[1], palette, read_options);
             break;
 
+        case FORMAT_MAP:
         case FORMAT_SCREEN:
+        case FORMAT_SEQUENCE:
             break;
 
         default:
-            image = image_read_png(arguments.arguments[1], std::make_shared<Palette>(Palette::c64_colodore));
+            image = image_read_png(arguments.arguments[1], palette, read_options);
         }
     
-        switch (format) {
-            case FORMAT_TEXT: {
-                auto text_screen = TextScreen(image, 0);
-                text_screen.save(make_output_filename(output_directory, arguments.arguments[2]));
-                break;
+        if (format == FORMAT_MAP) {
+            if (check_only || !regions.empty()) {
+                throw Exception("map format doesn't support checking or regions");
             }
-                
-            case FORMAT_SPRITES: {
-                auto sprites = SpriteSheet(image, 254);
-                sprites.save(make_output_filename(output_directory, arguments.arguments[2]));
-                break;
-            }
-                
-            case FORMAT_CHARSET: {
-                auto bitmap = Bitmap(image, Bitmap::C64, background_color, foreground_color);
-                save_file(make_output_filename(output_directory, arguments.arguments[2]), bitmap.bitmap);
-                break;
+
+            if (auto_background && !background_color) {
+                // The whole image is never in memory, so choose background for first band.
+                background_color = best_background(format, PngBandReader(arguments.arguments[1], palette, metatile_size * 8, read_options).read_band());
             }
-                
-            case FORMAT_BITMAP: {
-                auto bitmap = Bitmap(image, Bitmap::C64, background_color, foreground_color);
-                bitmap.save(make_output_filename(output_directory, arguments.arguments[2]));
-                break;
+
+            auto map = MetatileMap(metatile_size, charset_options, background_color, foreground_color);
+            auto reader = PngBandReader(arguments.arguments[1], palette, metatile_size * 8, read_options);
+            if (reader.get_width() % (metatile_size * 8) != 0 || reader.get_height() % (metatile_size * 8) != 0) {
+                throw Exception("image dimensions not multiple of metatile size");
             }
-                
-            case FORMAT_RAW:
-            case FORMAT_RAW_CHARSET:
-            case FORMAT_PRINTFOX: {
-                image_write_png(make_output_filename(output_directory, arguments.arguments[2]), image);
-                break;
+
+            for (size_t y = 0; y < reader.get_height(); y += metatile_size * 8) {
+                auto job = Arena::Scope(arena);
+                auto band = reader.read_band();
+                if (reduce) {
+                    reduce_colors(format, band, background_color);
+                }
+                map.add_band(band, y);
             }
-                
-            case FORMAT_NOTER: {
-                auto bitmap = Noter(image, background_color, foreground_color);
-                bitmap.save(make_output_filename(output_directory, arguments.arguments[2]));
-                break;
+
+            map.save(make_output_filename(output_directory, arguments.arguments[2]));
+        }
+        else if (format == FORMAT_SEQUENCE) {
+            if (check_only || regions.size() > 1) {
+                throw Exception("sequence format doesn't support checking or multiple regions");
             }
-            
-            case FORMAT_SCREEN: {
-                if (arguments.arguments.size() < 4) {
-                    std::cerr << "Usage: " << argv[0] << " screen start-charset.bin complete-charset-filename image.png ...\n";
-                    exit(1);
-                }
 
-                auto charset = arguments.arguments[1].empty() ? Charset() : Charset(load_file(arguments.arguments[1]));
+            auto sequence = FrameSequence(charset_options, keyframe_interval);
 
-                auto output_charset_file_name = arguments.arguments[2];
+            for (size_t i = 2; i < arguments.arguments.size(); i++) {
+                auto job = Arena::Scope(arena);
+                // Declared after job, so it is destroyed before the arena is reset, also when an exception is thrown.
+                auto frame = image_read_png(arguments.arguments[i], palette, read_options);
+                auto view = regions.empty() ? ImageView(frame) : ImageView(frame, regions[0]);
+                // All frames share one charset, so use the background chosen for the first one.
+                if (auto_background && !background_color) {
+                    background_color = best_background(format, view);
+                }
+                if (reduce) {
+                    reduce_colors(format, view, background_color);
+                }
+                sequence.add_frame(view, background_color.value_or(0));
+            }
 
-                for (auto i = 3; i < arguments.arguments.size(); i++) {
-                    auto file_name = arguments.arguments[i];
-                    image = image_read_png(file_name, std::make_shared<Palette>(Palette::c64_colodore));
-                    auto bitmap = Bitmap(image, Bitmap::C64, background_color, foreground_color);
+            sequence.save(make_output_filename(output_directory, arguments.arguments[1]));
+        }
+        else if (format == FORMAT_SCREEN) {
+            if (arguments.arguments.size() < 4) {
+                std::cerr << "Usage: " << argv[0] << " screen start-charset.bin complete-charset-filename image.png ...\n";
+                exit(1);
+            }
 
-                    auto screen = std::vector<uint8_t>(bitmap.get_width() * bitmap.get_height());
+            auto max_chars = charset_options.reduce && !check_only ? Charset::unlimited : charset_options.max_characters;
+            auto start_charset = arguments.arguments[1].empty() ? Charset(max_chars) : Charset(load_file(arguments.arguments[1]), max_chars);
+            start_charset.set_transforms(charset_options.transforms);
+            auto charset = start_charset;
+            auto screens = std::vector<PendingScreen>();
+            auto bank_ids = std::vector<uint8_t>();
 
-                    for (auto y = 0; y < bitmap.get_height(); y++) {
-                        for (auto x = 0; x < bitmap.get_width(); x++) {
-                            auto index = charset.add(bitmap.bitmap.data() + (y * bitmap.get_width() + x) * 8);
-                            screen[y * bitmap.get_width() + x] = index;
+            auto output_charset_file_name = arguments.arguments[2];
+
+            // Remap and save screens of current bank and its charset.
+            auto finish_bank = [&]() {
+                auto mapping = charset.finish(charset_options);
+                for (auto& screen : screens) {
+                    auto data = std::vector<uint8_t>();
+                    data.reserve(screen.indices.size() * (charset_options.max_characters > 256 ? 2 : 1));
+                    for (auto index : screen.indices) {
+                        data.push_back(mapping[index] & 0xff);
+                        if (charset_options.max_characters > 256) {
+                            data.push_back(mapping[index] >> 8);
                         }
                     }
-                    auto screen_file_name = file_name.substr(0, file_name.rfind('.')) + ".bin";
-                    save_file(make_output_filename(output_directory, screen_file_name), screen);
+                    save_file(screen.file_name, data);
+                    if (charset_options.transforms != 0) {
+                        auto transforms_file_name = screen.file_name;
+                        transforms_file_name.replace_filename(screen.file_name.stem().string() + "-transforms" + screen.file_name.extension().string());
+                        save_file(transforms_file_name, screen.transforms);
+                    }
                 }
+                screens.clear();
                 if (!output_charset_file_name.empty()) {
-                    charset.save(make_output_filename(output_directory, output_charset_file_name), false);
+                    auto charset_file_name = make_output_filename(output_directory, output_charset_file_name);
+                    if (charset_banks) {
+                        // Numbered like the bank ids stored in the banks file.
+                        auto bank = std::to_string(bank_ids.empty() ? 0 : bank_ids.back());
+                        charset_file_name.replace_filename(charset_file_name.stem().string() + "-" + bank + charset_file_name.extension().string());
+                    }
+                    charset.save(charset_file_name, false);
+                }
+            };
+
+            for (size_t i = 3; i < arguments.arguments.size(); i++) {
+                auto job = Arena::Scope(arena);
+                auto file_name = arguments.arguments[i];
+                // Declared after job, so it is destroyed before the arena is reset, also when an exception is thrown.
+                auto screen_image = image_read_png(file_name, palette, read_options);
+
+                for (size_t region_index = 0; region_index < std::max(regions.size(), size_t{1}); region_index++) {
+                    auto view = regions.empty() ? ImageView(screen_image) : ImageView(screen_image, regions[region_index]);
+                    // All screens share one charset, so use the background chosen for the first one.
+                    if (auto_background && !background_color) {
+                        background_color = best_background(format, view);
+                    }
+                    if (reduce) {
+                        reduce_colors(format, view, background_color);
+                    }
+                    if (check_only) {
+                        problems += check(format, view, file_name, charset, background_color, foreground_color);
+                        continue;
+                    }
+
+                    auto bitmap = Bitmap(view, Bitmap::C64, background_color, foreground_color);
+                    auto size = bitmap.get_width() * bitmap.get_height();
+
+                    if (charset_banks) {
+                        // Screens are split into banks in the given order, a bank ends when the next screen doesn't fit.
+                        if (!screens.empty() && charset.get_size() + charset.missing(bitmap.bitmap.data(), size) > charset_options.max_characters) {
+                            if (bank_ids.back() == UINT8_MAX) {
+                                throw Exception("too many charset banks");
+                            }
+                            finish_bank();
+                            // Assignment keeps the memory resource of charset, which outlives this job.
+                            charset = start_charset;
+                            bank_ids.push_back(bank_ids.back() + 1);
+                        }
+                        else {
+                            bank_ids.push_back(bank_ids.empty() ? 0 : bank_ids.back());
+                        }
+                    }
+
+                    auto& screen = screens.emplace_back();
+                    screen.indices.resize(size);
+                    screen.transforms.resize(size);
+
+                    for (size_t offset = 0; offset < size; offset++) {
+                        screen.indices[offset] = charset.add(bitmap.bitmap.data() + offset * 8, screen.transforms[offset]);
+                    }
+                    std::filesystem::path screen_file_name = file_name.substr(0, file_name.rfind('.')) + ".bin";
+                    if (regions.size() > 1) {
+                        screen_file_name = make_region_filename(screen_file_name, region_index);
+                    }
+                    screen.file_name = make_output_filename(output_directory, screen_file_name);
+                }
+            }
+            if (!check_only) {
+                finish_bank();
+                if (charset_banks && !output_charset_file_name.empty()) {
+                    auto banks_file_name = make_output_filename(output_directory, output_charset_file_name);
+                    banks_file_name.replace_filename(banks_file_name.stem().string() + "-banks" + banks_file_name.extension().string());
+                    save_file(banks_file_name, bank_ids);
+                }
+            }
+        }
+        else {
+            auto backgrounds = std::vector<std::optional<uint8_t>>(std::max(regions.size(), size_t{1}), background_color);
+            if (auto_background) {
+                for (size_t region_index = 0; region_index < backgrounds.size(); region_index++) {
+                    backgrounds[region_index] = best_background(format, regions.empty() ? ImageView(image) : ImageView(image, regions[region_index]));
                 }
-                break;
             }
 
-            case FORMAT_SPECTRUM: {
-                auto bitmap = Bitmap(image, Bitmap::SPECTRUM, background_color, foreground_color);
-                std::vector<const std::vector<uint8_t>*> data;
-                data.emplace_back(&bitmap.bitmap);
-                save_file(make_output_filename(output_directory, arguments.arguments[2]), data);
-                break;
+            if (reduce) {
+                for (size_t region_index = 0; region_index < std::max(regions.size(), size_t{1}); region_index++) {
+                    reduce_colors(format, regions.empty() ? ImageView(image) : ImageView(image, regions[region_index]), backgrounds[region_index]);
+                }
+            }
+
+            if (check_only) {
+                for (size_t region_index = 0; region_index < std::max(regions.size(), size_t{1}); region_index++) {
+                    auto job = Arena::Scope(arena);
+                    // Same limits as used when converting.
+                    auto charset = Charset(charset_options.reduce ? Charset::unlimited : charset_options.max_characters);
+                    charset.set_transforms(charset_options.transforms);
+                    problems += check(format, regions.empty() ? ImageView(image) : ImageView(image, regions[region_index]), arguments.arguments[1], charset, backgrounds[region_index], foreground_color);
+                }
+            }
+            else {
+                auto file_name = make_output_filename(output_directory, arguments.arguments[2]);
+
+                if (regions.empty()) {
+                    convert(format, image, file_name, backgrounds[0], foreground_color, charset_options, vertical_shifts, deduplicate_sprites, fixed_charset);
+                }
+                else {
+                    for (size_t region_index = 0; region_index < regions.size(); region_index++) {
+                        auto job = Arena::Scope(arena);
+                        convert(format, ImageView(image, regions[region_index]), regions.size() > 1 ? make_region_filename(file_name, region_index) : file_name, backgrounds[region_index], foreground_color, charset_options, vertical_shifts, deduplicate_sprites, fixed_charset);
+                    }
+                }
             }
         }
+
+        write_compressed_files();
     }
     catch(Exception const &ex) {
         std::cerr << argv[0] << ": " << ex.what() << "\n";
         exit(1);
     }
     
-    exit(0);
+    exit(problems > 0 ? 1 : 0);
 }
 
@@ -35,14 +35,57 @@
 #ifndef HAD_READ
 #define HAD_READ
 
+#include <memory>
 #include <string>
+#include <unordered_map>
 
+#include "Dither.h"
 #include "Image.h"
 #include "Palette.h"
 
-std::shared_ptr<Image> image_read_png(const std::string file_name, std::shared_ptr<Palette> palette);
-std::shared_ptr<Image> image_read_printfox(const std::string file_name, std::shared_ptr<Palette> palette);
-std::shared_ptr<Image> image_read_raw(const std::string file_name, std::shared_ptr<Palette> palette, size_t width, size_t height);
+class ReadOptions {
+public:
+    // Store pixels tile-major in tiles of this size (0 for row-major).
+    size_t tile_width = 0;
+    size_t tile_height = 0;
+    // Map colors not in palette to the closest palette entry instead of failing.
+    bool nearest_color = false;
+    // Decode colors with this palette, which must have the same order as the image palette.
+    std::shared_ptr<const Palette> source_palette;
+    // Choose source palette from known variants of the image palette.
+    bool detect_source_palette = false;
+    // Reduce colors not in palette by dithering (implies nearest color matching).
+    Dither::Method dither = Dither::NONE;
+};
+
+class PngReader;
+
+// Reads PNG image in bands of rows, so the whole image never has to be in memory.
+class PngBandReader {
+public:
+    PngBandReader(const std::string& file_name, std::shared_ptr<const Palette> palette, size_t band_height, const ReadOptions& options = {});
+    ~PngBandReader();
+
+    [[nodiscard]] size_t get_width() const;
+    [[nodiscard]] size_t get_height() const;
+
+    // Returns next band, or nullptr after last band. Last band is shorter if image height is not a multiple of band height.
+    std::shared_ptr<Image> read_band();
+
+private:
+    std::unique_ptr<PngReader> reader;
+    std::shared_ptr<const Palette> palette;
+    std::shared_ptr<const Palette> source_palette;
+    size_t band_height;
+    ReadOptions options;
+    size_t next_row = 0;
+};
+
+std::shared_ptr<Image> image_read_png(const std::string file_name, std::shared_ptr<const Palette> palette, const ReadOptions& options = {});
+std::shared_ptr<Image> image_read_printfox(const std::string file_name, std::shared_ptr<const Palette> palette);
+std::shared_ptr<Image> image_read_raw(const std::string file_name, std::shared_ptr<const Palette> palette, size_t width, size_t height, const ReadOptions& options = {});
 std::shared_ptr<Image> image_read_raw_charset(const std::string file_name);
 
+std::unordered_map<uint32_t, size_t> png_color_histogram(const std::string& file_name);
+
 #endif // HAD_READ
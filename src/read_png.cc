@@ -34,105 +34,156 @@
 
 #include "read.h"
 
-#include <cstring>
-
-#include <png.h>
-
 #include "Exception.h"
-#include "utils.h"
+#include "PaletteRegistry.h"
+#include "PngReader.h"
+#include "Status.h"
 
-std::shared_ptr<Image> image_read_png(const std::string file_name, std::shared_ptr<Palette> palette) {
-    auto fp = make_shared_file(file_name, "rb");
-    
-    uint8_t header[8];
+// Convert row of RGBA pixels to palette indices.
+static Status decode_row(const uint8_t *row, size_t width, size_t y, const Palette& source_palette, uint8_t transparent_index, bool nearest_color, uint8_t *indices);
 
-    if (fread(header, 8, 1, fp.get()) != 1) {
-        throw Exception("can't read PNG header from '%s'", file_name.c_str()).append_system_error();
+std::shared_ptr<Image> image_read_png(const std::string file_name, std::shared_ptr<const Palette> palette, const ReadOptions& options) {
+    auto source_palette = options.source_palette ? options.source_palette : palette;
+    if (options.detect_source_palette) {
+        source_palette = PaletteRegistry::detect(png_color_histogram(file_name), palette);
     }
 
-    if (png_sig_cmp(header, 0, 8) != 0) {
-        throw Exception("'%s' is not a PNG image", file_name.c_str());
-    }
+    auto reader = PngReader(file_name);
+    auto width = reader.get_width();
+    auto height = reader.get_height();
+
+    auto image = std::allocate_shared<Image>(std::pmr::polymorphic_allocator<Image>(), width, height, palette, options.tile_width, options.tile_height, Image::bits_per_pixel_for(*palette, reader.has_transparency()));
     
-    auto png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    if (options.dither != Dither::NONE) {
+        auto rgba = std::pmr::vector<uint8_t>(width * height * 4);
+        for (size_t y = 0; y < height; y++) {
+            auto row = reader.read_row();
+            for (size_t x = 0; x < width; x++) {
+                auto alpha = row[x * 4 + 3];
+                if (alpha != 0 && alpha != 255) {
+                    throw Status(Status::INVALID_ALPHA, x, y, alpha).exception();
+                }
+            }
+            std::copy(row, row + width * 4, rgba.data() + y * width * 4);
+        }
 
-    if (png_ptr == NULL) {
-        throw Exception("can't create PNG reader");
+        auto indices = std::pmr::vector<uint8_t>(width * height);
+        Dither::dither(options.dither, *source_palette, rgba.data(), width, height, indices.data());
+        for (size_t y = 0; y < height; y++) {
+            image->set_row(y, indices.data() + y * width);
+        }
+        return image;
     }
 
-    auto info_ptr = png_create_info_struct(png_ptr);
+    auto indices = std::pmr::vector<uint8_t>(width);
 
-    if (info_ptr == NULL) {
-        throw Exception("can't create PNG info");
-    }
+    for (size_t y = 0; y < height; y++) {
+        auto status = decode_row(reader.read_row(), width, y, *source_palette, palette->transparent_index, options.nearest_color, indices.data());
+        if (!status.ok()) {
+            throw status.exception();
+        }
 
-    if (setjmp(png_jmpbuf(png_ptr))) {
-        throw Exception("can't read PNG image '%s'", file_name.c_str()); // TODO: error details
+        image->set_row(y, indices.data());
     }
 
-    png_init_io(png_ptr, fp.get());
-    png_set_sig_bytes(png_ptr, 8);
-    png_read_info(png_ptr, info_ptr);
-    
-    auto width = png_get_image_width(png_ptr, info_ptr);
-    auto height = png_get_image_height(png_ptr, info_ptr);
-    auto color_type = png_get_color_type(png_ptr, info_ptr);
-    auto bit_depth = png_get_bit_depth(png_ptr, info_ptr);
-    
-    if (color_type == PNG_COLOR_TYPE_PALETTE) {
-        png_set_palette_to_rgb(png_ptr);
-    }
-    else if (color_type == PNG_COLOR_TYPE_GRAY) {
-        png_set_gray_to_rgb(png_ptr);
-    }
-    if (bit_depth == 16) {
-        png_set_strip_16(png_ptr);
-    }
-    
-    if (color_type == PNG_COLOR_TYPE_RGB_ALPHA || color_type == PNG_COLOR_TYPE_GRAY_ALPHA) {
-        //png_set_invert_alpha(png_ptr);
+    return image;
+}
+
+
+PngBandReader::PngBandReader(const std::string& file_name, std::shared_ptr<const Palette> palette, size_t band_height, const ReadOptions& options) : reader(std::make_unique<PngReader>(file_name)), palette(std::move(palette)), band_height(band_height), options(options) {
+    if (options.dither != Dither::NONE) {
+        throw Exception("dithering not supported when reading image in bands");
     }
-    else {
-        png_set_filler(png_ptr, 255, PNG_FILLER_AFTER);
+    source_palette = options.source_palette ? options.source_palette : this->palette;
+    if (options.detect_source_palette) {
+        source_palette = PaletteRegistry::detect(png_color_histogram(file_name), this->palette);
     }
+}
 
-    png_read_update_info(png_ptr, info_ptr);
 
-    auto image = std::make_shared<Image>(width, height, palette);
-    
-    if (png_get_rowbytes(png_ptr, info_ptr) != width * 4) {
-        throw Exception("unexpected row size %zu", png_get_rowbytes(png_ptr, info_ptr));
-    }
-    uint8_t buffer[width * height * 4];
-    uint8_t *rows[height];
-    
-    for (size_t i = 0; i < height; i++) {
-        rows[i] = buffer + i * width * 4;
+PngBandReader::~PngBandReader() = default;
+
+
+size_t PngBandReader::get_width() const {
+    return reader->get_width();
+}
+
+
+size_t PngBandReader::get_height() const {
+    return reader->get_height();
+}
+
+
+std::shared_ptr<Image> PngBandReader::read_band() {
+    if (next_row >= reader->get_height()) {
+        return {};
     }
-    
-    png_read_image(png_ptr, reinterpret_cast<png_bytepp>(rows));
-    
+
+    auto width = reader->get_width();
+    auto height = std::min(band_height, reader->get_height() - next_row);
+    auto image = std::allocate_shared<Image>(std::pmr::polymorphic_allocator<Image>(), width, height, palette, options.tile_width, options.tile_height, Image::bits_per_pixel_for(*palette, reader->has_transparency()));
+    auto indices = std::pmr::vector<uint8_t>(width);
+
     for (size_t y = 0; y < height; y++) {
-        for (size_t x = 0; x < width; x++) {
-            uint32_t pixel_rgb = (rows[y][x * 4] << 16) | (rows[y][x * 4 + 1] << 8) | (rows[y][x * 4 + 2]);
-            auto alpha = rows[y][x * 4 + 3];
-            
-            try {
-                if (alpha == 255) {
-                    image->set(x, y, palette->lookup(pixel_rgb));
-                }
-                else if (alpha == 0) {
-                    image->set(x, y, palette->transparent_index);
-                }
-                else {
-                    throw Exception("invalid alpha value %u", alpha);
+        auto status = decode_row(reader->read_row(), width, next_row + y, *source_palette, palette->transparent_index, options.nearest_color, indices.data());
+        if (!status.ok()) {
+            throw status.exception();
+        }
+
+        image->set_row(y, indices.data());
+    }
+    next_row += height;
+
+    return image;
+}
+
+
+static Status decode_row(const uint8_t *row, size_t width, size_t y, const Palette& source_palette, uint8_t transparent_index, bool nearest_color, uint8_t *indices) {
+    for (size_t x = 0; x < width; x++) {
+        uint32_t pixel_rgb = (row[x * 4] << 16) | (row[x * 4 + 1] << 8) | (row[x * 4 + 2]);
+        auto alpha = row[x * 4 + 3];
+
+        if (alpha == 255) {
+            if (nearest_color) {
+                indices[x] = source_palette.lookup_nearest(pixel_rgb);
+            }
+            else {
+                auto index = source_palette.find(pixel_rgb);
+                if (!index) {
+                    return {Status::INVALID_COLOR, x, y, pixel_rgb};
                 }
+                indices[x] = *index;
             }
-            catch(Exception &ex) {
-                throw ex.set_position(x, y);
+        }
+        else if (alpha == 0) {
+            indices[x] = transparent_index;
+        }
+        else {
+            return {Status::INVALID_ALPHA, x, y, alpha};
+        }
+    }
+
+    return {};
+}
+
+
+std::unordered_map<uint32_t, size_t> png_color_histogram(const std::string& file_name) {
+    auto reader = PngReader(file_name);
+    auto histogram = std::unordered_map<uint32_t, size_t>();
+    // Sample at most 256 rows spread over the image.
+    auto step = std::max(reader.get_height() / 256, size_t{1});
+
+    for (size_t y = 0; y < reader.get_height(); y++) {
+        auto row = reader.read_row();
+        if (y % step != 0) {
+            continue;
+        }
+        for (size_t x = 0; x < reader.get_width(); x++) {
+            if (row[x * 4 + 3] == 255) {
+                histogram[(row[x * 4] << 16) | (row[x * 4 + 1] << 8) | (row[x * 4 + 2])] += 1;
             }
         }
     }
 
-    return image;
+    return histogram;
 }
@@ -38,7 +38,7 @@
 #include "utils.h"
 
 
-std::shared_ptr<Image> image_read_printfox(const std::string file_name, std::shared_ptr<Palette> palette) {
+std::shared_ptr<Image> image_read_printfox(const std::string file_name, std::shared_ptr<const Palette> palette) {
     auto fp = make_shared_file(file_name, "rb");
     
     size_t width, height;
@@ -125,7 +125,7 @@ std::shared_ptr<Image> image_read_printfox(const std::string file_name, std::sha
         throw Exception("%zu bytes of trailing data in file '%s'\n", end - offset, file_name.c_str());
     }
 
-    auto image = std::make_shared<Image>(width * 8, height * 8, palette);
+    auto image = std::make_shared<Image>(width * 8, height * 8, palette, 0, 0, Image::bits_per_pixel_for(*palette, false));
     
     for (size_t tile = 0; tile < width * height; tile++) {
         size_t y = tile / width;
@@ -44,21 +44,18 @@
 #include "utils.h"
 
 
-std::shared_ptr<Image> image_read_raw(const std::string file_name, std::shared_ptr<Palette> palette, size_t width, size_t height) {
+std::shared_ptr<Image> image_read_raw(const std::string file_name, std::shared_ptr<const Palette> palette, size_t width, size_t height, const ReadOptions& options) {
     auto fp = make_shared_file(file_name, "rb");
     
-    auto image = std::make_shared<Image>(width, height, palette);
+    auto image = std::allocate_shared<Image>(std::pmr::polymorphic_allocator<Image>(), width, height, palette, options.tile_width, options.tile_height);
 
-    uint8_t buffer[width * height];
+    auto row = std::pmr::vector<uint8_t>(width);
 
-    if (fread(buffer, width * height, 1, fp.get()) != 1) {
-        throw Exception("can't read image data").append_system_error();
-    }
-    
     for (size_t y = 0; y < height; y++) {
-        for (size_t x = 0; x < width; x++) {
-            image->set(x, y, buffer[y * width + x]);
+        if (fread(row.data(), width, 1, fp.get()) != 1) {
+            throw Exception("can't read image data").append_system_error();
         }
+        image->set_row(y, row.data());
     }
     
     return image;
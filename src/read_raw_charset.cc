@@ -35,6 +35,7 @@
 #include "read.h"
 
 #include "Exception.h"
+#include "PaletteRegistry.h"
 #include "utils.h"
 
 
@@ -57,7 +58,7 @@ std::shared_ptr<Image> image_read_raw_charset(const std::string file_name) {
         throw Exception("can't read charset").append_system_error();
     }
 
-    auto image = std::make_shared<Image>(width * 8, height * 8, std::make_shared<Palette>(Palette::c64_colodore));
+    auto image = std::make_shared<Image>(width * 8, height * 8, PaletteRegistry::c64_colodore(), 0, 0, 1);
     
     for (size_t tile = 0; tile < width * height; tile++) {
         size_t y = tile / width;
@@ -32,10 +32,13 @@
   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
 #include <filesystem>
+#include <thread>
 
 #include "utils.h"
 
+#include "CompressedFileWriter.h"
 #include "Exception.h"
 
 std::shared_ptr<std::FILE> make_shared_file(const std::string& file_name, const std::string& flags) {
@@ -67,7 +70,16 @@ std::vector<uint8_t> load_file(const std::string& file_name) {
 }
 
 
+// Set while compression is enabled, writes saved files in background threads.
+static std::unique_ptr<CompressedFileWriter> compressed_file_writer;
+
+
 void save_file(const std::string& file_name, const uint8_t* data, size_t length) {
+    if (compressed_file_writer) {
+        compressed_file_writer->save(file_name, data, length);
+        return;
+    }
+
     auto fp = make_shared_file(file_name, "wb");
 
     fwrite(data, length, 1, fp.get());
@@ -77,22 +89,77 @@ void save_file(const std::string& file_name, const uint8_t* data, size_t length)
 
 
 void save_file(const std::string& file_name, std::vector<uint8_t>& data) {
-    auto fp = make_shared_file(file_name, "wb");
-    
-    fwrite(data.data(), data.size(), 1, fp.get());
-    
-    // TODO: write error handling
+    save_file(file_name, data.data(), data.size());
 }
 
 
 void save_file(const std::string& file_name, std::vector<const std::vector<uint8_t>*>& data_list) {
-    auto fp = make_shared_file(file_name, "wb");
+    auto data = std::vector<uint8_t>();
 
-    for (const auto& data : data_list) {
-        fwrite(data->data(), data->size(), 1, fp.get());
+    for (const auto& part : data_list) {
+        data.insert(data.end(), part->begin(), part->end());
     }
 
-    // TODO: write error handling
+    save_file(file_name, data);
+}
+
+
+void set_compress_files(bool compress) {
+    if (compress) {
+        if (!compressed_file_writer) {
+            compressed_file_writer = std::make_unique<CompressedFileWriter>();
+        }
+    }
+    else {
+        write_compressed_files();
+    }
+}
+
+
+void write_compressed_files() {
+    if (compressed_file_writer) {
+        auto writer = std::move(compressed_file_writer);
+        writer->finish();
+    }
+}
+
+
+size_t parallel_threads() {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+
+void parallel_for(size_t count, const std::function<void(size_t begin, size_t end)>& function) {
+    auto threads = std::min(parallel_threads(), count);
+
+    if (threads <= 1) {
+        if (count > 0) {
+            function(0, count);
+        }
+        return;
+    }
+
+    auto workers = std::vector<std::thread>();
+    auto exceptions = std::vector<std::exception_ptr>(threads);
+
+    for (size_t i = 0; i < threads; i++) {
+        workers.emplace_back([&, i] {
+            try {
+                function(count * i / threads, count * (i + 1) / threads);
+            }
+            catch (...) {
+                exceptions[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (const auto& exception : exceptions) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
 }
 
 
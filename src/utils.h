@@ -37,6 +37,7 @@
 
 #include <cstdio>
 #include <cstdarg>
+#include <functional>
 #include <memory>
 #include <string>
 #include <system_error>
@@ -49,6 +50,14 @@ std::vector<uint8_t> load_file(const std::string& file_name);
 void save_file(const std::string& file_name, const uint8_t* data, size_t length);
 void save_file(const std::string& file_name, std::vector<uint8_t>& data);
 void save_file(const std::string& file_name, std::vector<const std::vector<uint8_t>*>& data_list);
+// While enabled, saved files are compressed and written in background threads; write_compressed_files() waits for them.
+void set_compress_files(bool compress);
+void write_compressed_files();
+
+// Split [0, count) into consecutive ranges and call function(begin, end) for each of them on all available cores.
+// Exceptions thrown by function are rethrown in the calling thread.
+void parallel_for(size_t count, const std::function<void(size_t begin, size_t end)>& function);
+size_t parallel_threads();
 
 std::string string_format(const char *format, ...) __attribute__ ((format (printf, 1, 2)));
 std::string string_format_v(const char *format, va_list ap);
@@ -40,7 +40,7 @@
 #include "utils.h"
 
 
-void image_write_png(const std::string file_name, std::shared_ptr<Image> image) {
+void image_write_png(const std::string file_name, const ImageView& image) {
     auto fp = make_shared_file(file_name, "wb");
     
     auto png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
@@ -61,20 +61,20 @@ void image_write_png(const std::string file_name, std::shared_ptr<Image> image)
 
     png_init_io(png_ptr, fp.get());
 
-    png_set_IHDR(png_ptr, info_ptr, static_cast<png_uint_32>(image->get_width()), static_cast<png_uint_32>(image->get_height()), 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+    png_set_IHDR(png_ptr, info_ptr, static_cast<png_uint_32>(image.get_width()), static_cast<png_uint_32>(image.get_height()), 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
 
     png_write_info(png_ptr, info_ptr);
 
-    uint8_t buffer[image->get_width() * image->get_height() * 3];
-    uint8_t *rows[image->get_height()];
+    uint8_t buffer[image.get_width() * image.get_height() * 3];
+    uint8_t *rows[image.get_height()];
     
-    for (size_t i = 0; i < image->get_height(); i++) {
-        rows[i] = buffer + i * image->get_width() * 3;
+    for (size_t i = 0; i < image.get_height(); i++) {
+        rows[i] = buffer + i * image.get_width() * 3;
     }
     
-    for (size_t y = 0; y < image->get_height(); y++) {
-        for (size_t x = 0; x < image->get_width(); x++) {
-            auto rgb = image->get_rgb(x, y);
+    for (size_t y = 0; y < image.get_height(); y++) {
+        for (size_t x = 0; x < image.get_width(); x++) {
+            auto rgb = image.get_rgb(x, y);
             rows[y][x * 3] = rgb >> 16;
             rows[y][x * 3 + 1] = (rgb >> 8) & 0xff;
             rows[y][x * 3 + 2] = rgb & 0xff;
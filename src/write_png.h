@@ -37,9 +37,9 @@
 
 #include <string>
 
-#include "Image.h"
+#include "ImageView.h"
 #include "Palette.h"
 
-void image_write_png(const std::string file_name, std::shared_ptr<Image> image);
+void image_write_png(const std::string file_name, const ImageView& image);
 
 #endif // HAD_WRITE_PNG